@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    Automation.cpp
+
+  ==============================================================================
+*/
+
+#include "Automation.h"
+
+bool AutomationSet::loadFromFile(const juce::File& file, AutomationSet& result, juce::String& error)
+{
+    juce::var json;
+    auto parseResult = juce::JSON::parse(file.loadFileAsString(), json);
+    if(parseResult.failed())
+    {
+        error = file.getFileName() + ": " + parseResult.getErrorMessage();
+        return false;
+    }
+
+    if(json.hasProperty("controlRate"))
+        result.controlRate = juce::jmax(1, static_cast<int>(json["controlRate"]));
+
+    auto* lanes = json["lanes"].getDynamicObject();
+    if(lanes == nullptr)
+    {
+        error = file.getFileName() + ": no \"lanes\" object";
+        return false;
+    }
+
+    for(auto& property : lanes->getProperties())
+    {
+        AutomationLane lane;
+        lane.parameterID = property.name.toString();
+
+        if(auto* points = property.value.getArray())
+        {
+            for(auto& point : *points)
+            {
+                if(point.size() < 2)
+                {
+                    error = lane.parameterID + ": breakpoints are [seconds, value] pairs";
+                    return false;
+                }
+                lane.points.push_back({ static_cast<double>(point[0]), static_cast<float>(point[1]) });
+            }
+        }
+
+        if(lane.points.empty())
+        {
+            error = lane.parameterID + ": lane has no breakpoints";
+            return false;
+        }
+
+        std::stable_sort(lane.points.begin(), lane.points.end(),
+                         [](const auto& a, const auto& b) { return a.time < b.time; });
+        result.lanes.push_back(std::move(lane));
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    Automation.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+struct AutomationPoint
+{
+    double time;    // seconds
+    float value;    // parameter units, as the plugin's parameters hold them, see below
+};
+
+struct AutomationLane
+{
+    juce::String parameterID;
+    std::vector<AutomationPoint> points;   // sorted by time
+};
+
+/*
+ Breakpoint automation for an offline render, read from JSON:
+
+   { "controlRate": 32,
+     "lanes": { "hp": [[0, 20], [12.5, 10690]], "LowCutSlope": [[0, 1], [8, 3]] } }
+
+ Values are in the parameter's own units, not Hz. hp and lp take their linear 20-20000
+ knob range, which makeChainSettings maps exponentially: 20 is 20 Hz, 20000 is 20 kHz and
+ 10010, halfway, is about 632 Hz; the hp lane above sweeps 20 Hz to 800 Hz. For f Hz write
+ 20 + 19980 * log(f / 20) / log(1000). Slopes and other choices take their index.
+
+ Parameters are set once every controlRate samples, so coefficients are redesigned at that
+ rate and never per sample.
+ */
+struct AutomationSet
+{
+    int controlRate = 32;
+    std::vector<AutomationLane> lanes;
+
+    bool isEmpty() const { return lanes.empty(); }
+
+    static bool loadFromFile(const juce::File& file, AutomationSet& result, juce::String& error);
+};
+
+/*
+ Walks one lane forward through a render. Renders only move forward in time, so each lookup
+ is a step or two along the breakpoints. Continuous parameters interpolate linearly between
+ breakpoints, choices hold the last breakpoint's value.
+ */
+struct AutomationCursor
+{
+    AutomationCursor(const AutomationLane& l, juce::RangedAudioParameter& p)
+        : lane(&l), parameter(&p),
+          isStepped(dynamic_cast<juce::AudioParameterChoice*>(&p) != nullptr
+                 || dynamic_cast<juce::AudioParameterBool*>(&p) != nullptr)
+    {}
+
+    void rewind() { index = 0; lastValue = std::numeric_limits<float>::quiet_NaN(); }
+
+    // Sets the parameter to the lane's value at time, skipped when nothing changed
+    void apply(double time)
+    {
+        auto value = getValueAt(time);
+        if(value == lastValue)
+            return;
+
+        lastValue = value;
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+private:
+    const AutomationLane* lane;
+    juce::RangedAudioParameter* parameter;
+    bool isStepped;
+    size_t index = 0;
+    float lastValue = std::numeric_limits<float>::quiet_NaN();
+
+    float getValueAt(double time)
+    {
+        const auto& points = lane->points;
+        while(index + 1 < points.size() && points[index + 1].time <= time)
+            ++index;
+
+        const auto& from = points[index];
+        if(isStepped || time <= from.time || index + 1 == points.size())
+            return from.value;
+
+        const auto& to = points[index + 1];
+        const auto proportion = (time - from.time) / (to.time - from.time);
+        return from.value + static_cast<float>(proportion) * (to.value - from.value);
+    }
+};
@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Headless batch renderer: runs audio files through the plugin's DSP without a host.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+#include "WorkStealingPool.h"
+
+static void printUsage()
+{
+    std::cout << "Usage: SqueezeRender [options] <file or folder>...\n"
+                 "  --state <file>     plugin state blob or XML preset to render with\n"
+                 "  --bank <file>      preset bank to recall --preset from (default: the plugin's)\n"
+                 "  --preset <name>    recall a preset from the bank, after --state\n"
+                 "  --param <id=value> set one parameter, e.g. --param LowCutSlope=48\n"
+                 "                     hp/lp take parameter units, not Hz, see Automation.h\n"
+                 "  --out <folder>     where renders are written (default: current folder)\n"
+                 "  --automation <file> JSON breakpoint lanes, see Automation.h\n"
+                 "  --control-rate <samples> automation update period (default: 32)\n"
+                 "  --block <samples>  processing block size (default: 65536)\n"
+                 "  --jobs <n>         worker threads (default: one per core)\n"
+                 "  --trace <file>     write a Chrome trace of the render (chrome://tracing, ui.perfetto.dev)\n"
+                 "  --log              write audio thread diagnostics to the plugin's Diagnostics.txt\n"
+                 "  --table-report <rate> print cutoff table memory and accuracy at that rate, then exit\n"
+                 "  --test             run the DSP unit tests, then exit\n";
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    settings.outputDirectory = juce::File::getCurrentWorkingDirectory();
+    int numJobs = juce::SystemStats::getNumCpus();
+    juce::Array<juce::File> inputs;
+    juce::File automationFile, traceFile;
+    int controlRate = 0;
+
+    const juce::StringArray args(argv + 1, argc - 1);
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    for(int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        auto takeValue = [&] { return ++i < args.size() ? args[i] : juce::String(); };
+
+        if(arg == "--state")
+            settings.stateFile = cwd.getChildFile(takeValue());
+        else if(arg == "--bank")
+            settings.presetBank = cwd.getChildFile(takeValue());
+        else if(arg == "--preset")
+            settings.presetName = takeValue();
+        else if(arg == "--param")
+        {
+            auto pair = takeValue();
+            settings.parameters.set(pair.upToFirstOccurrenceOf("=", false, false).trim(),
+                                    pair.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+        else if(arg == "--out")
+            settings.outputDirectory = cwd.getChildFile(takeValue());
+        else if(arg == "--automation")
+            automationFile = cwd.getChildFile(takeValue());
+        else if(arg == "--control-rate")
+            controlRate = juce::jmax(1, takeValue().getIntValue());
+        else if(arg == "--block")
+            settings.blockSize = juce::jlimit(64, 1 << 20, takeValue().getIntValue());
+        else if(arg == "--jobs")
+            numJobs = juce::jmax(1, takeValue().getIntValue());
+        else if(arg == "--trace")
+            traceFile = cwd.getChildFile(takeValue());
+        else if(arg == "--log")
+            DiagnosticLog::setEnabled(true);
+        else if(arg == "--table-report")
+        {
+            const auto sampleRate = juce::jmax(8000.0, takeValue().getDoubleValue());
+            const auto tables = CutLookupTables::getForSampleRate(sampleRate);
+            std::cout << "Cutoff tables at " << sampleRate << " Hz: " << tables->getNumPoints() << " points, "
+                      << juce::String(tables->getMemoryBytes() / 1024.0, 1) << " KB, max error "
+                      << juce::String(tables->measureMaxErrorDb(), 4) << " dB\n";
+            return 0;
+        }
+        else if(arg == "--test")
+        {
+            juce::UnitTestRunner runner;
+            runner.setAssertOnFailure(false);
+            runner.runTestsInCategory("SqueezeFilter");
+
+            int numFailures = 0;
+            for(int r = 0; r < runner.getNumResults(); ++r)
+                numFailures += runner.getResult(r)->failures;
+            return numFailures > 0 ? 1 : 0;
+        }
+        else if(arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if(arg.startsWith("--"))
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            auto file = cwd.getChildFile(arg);
+            if(file.isDirectory())
+                inputs.addArray(file.findChildFiles(juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac"));
+            else
+                inputs.add(file);
+        }
+    }
+
+    if(inputs.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if(automationFile != juce::File())
+    {
+        juce::String error;
+        if(! AutomationSet::loadFromFile(automationFile, settings.automation, error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    if(controlRate > 0)
+        settings.automation.controlRate = controlRate;
+
+    // Workers would write the same output at once, or over a file another one is reading
+    juce::Array<juce::File> outputs;
+    for(auto& input : inputs)
+    {
+        const auto output = OfflineRenderer::getOutputFile(settings.outputDirectory, input);
+        const auto other = outputs.indexOf(output);
+        if(other >= 0)
+        {
+            std::cerr << inputs[other].getFullPathName() << " and " << input.getFullPathName() << " would both be written to "
+                      << output.getFullPathName() << ", render them to different --out folders\n";
+            return 1;
+        }
+        if(inputs.contains(output))
+        {
+            std::cerr << "Rendering " << input.getFullPathName() << " would overwrite the input "
+                      << output.getFullPathName() << ", choose another --out folder\n";
+            return 1;
+        }
+        outputs.add(output);
+    }
+
+    if(! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Cannot create " << settings.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // Started before the renderers so their state loads are in it, finished after they are gone
+    juce::SharedResourcePointer<Tracer> tracer;
+    if(traceFile != juce::File() && ! tracer->start(traceFile))
+    {
+        std::cerr << "Cannot write " << traceFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // One processor per worker, each loaded with the same parameters
+    WorkStealingPool pool(juce::jmin(numJobs, inputs.size()));
+    juce::OwnedArray<OfflineRenderer> renderers;
+    for(int w = 0; w < pool.getNumWorkers(); ++w)
+    {
+        auto* renderer = renderers.add(new OfflineRenderer(settings));
+        juce::String error;
+        if(! renderer->loadParameters(error))
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+
+    if(settings.stateFile != juce::File() && ! renderers.isEmpty())
+        std::cout << "State loaded in " << juce::String(renderers[0]->getStateLoadMicroseconds(), 1) << " us\n";
+
+    juce::CriticalSection reportLock;
+    double totalAudioSeconds = 0.0;
+    int numFailed = 0;
+
+    for(auto& input : inputs)
+    {
+        pool.add([&, input](int worker)
+        {
+            auto result = renderers[worker]->render(input);
+
+            const juce::ScopedLock lock(reportLock);
+            if(result.ok)
+            {
+                totalAudioSeconds += result.audioSeconds;
+                std::cout << input.getFileName() << ": " << juce::String(result.audioSeconds, 1) << " s in "
+                          << juce::String(result.wallSeconds, 2) << " s, "
+                          << juce::String(result.getRealtimeMultiple(), 1) << "x realtime, peak "
+                          << juce::String(result.peakDb, 1) << " dBFS, true peak " << juce::String(result.truePeakDb, 1) << " dBTP\n"
+                          << "    integrated " << juce::String(result.inputLufs, 1) << " LUFS in, "
+                          << juce::String(result.outputLufs, 1) << " LUFS out ("
+                          << juce::String(result.outputLufs - result.inputLufs, 1) << " LU)\n";
+               #if SQUEEZE_TELEMETRY
+                std::cout << "    " << result.telemetry.toString() << "\n";
+               #endif
+            }
+            else
+            {
+                ++numFailed;
+                std::cerr << input.getFileName() << ": " << result.error << "\n";
+            }
+        });
+    }
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    pool.runAll();
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    std::cout << inputs.size() - numFailed << " of " << inputs.size() << " files, "
+              << juce::String(totalAudioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 2) << " s on "
+              << pool.getNumWorkers() << " workers, "
+              << juce::String(wallSeconds > 0.0 ? totalAudioSeconds / wallSeconds : 0.0, 1) << "x realtime\n";
+    if(! renderers.isEmpty())
+        std::cout << "Per instance " << renderers[0]->getAnalyzerMemoryReport() << "\n";
+
+    return numFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,312 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer(const RenderSettings& s) : settings(s)
+{
+    formatManager.registerBasicFormats();
+    writerThread.startThread();
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    writerThread.stopThread(2000);
+}
+
+bool OfflineRenderer::loadParameters(juce::String& error)
+{
+    if(settings.stateFile != juce::File())
+    {
+        if(! settings.stateFile.existsAsFile())
+        {
+            error = "State file not found: " + settings.stateFile.getFullPathName();
+            return false;
+        }
+
+        // A preset is the parameter tree as XML, anything else is taken as a plugin state blob
+        if(auto xml = juce::parseXML(settings.stateFile))
+        {
+            auto tree = juce::ValueTree::fromXml(*xml);
+            if(! tree.hasType(processor.apvts.state.getType()))
+            {
+                error = "Not a SqueezeFilter preset: " + settings.stateFile.getFullPathName();
+                return false;
+            }
+            processor.apvts.replaceState(tree);
+        }
+        else
+        {
+            juce::MemoryBlock data;
+            settings.stateFile.loadFileAsData(data);
+            processor.setStateInformation(data.getData(), static_cast<int>(data.getSize()));
+        }
+    }
+
+    if(settings.presetName.isNotEmpty())
+    {
+        if(settings.presetBank != juce::File() && ! processor.openPresetBank(settings.presetBank))
+        {
+            error = "Not a preset bank: " + settings.presetBank.getFullPathName();
+            return false;
+        }
+
+        auto index = -1;
+        processor.usePresetBank([this, &index](const PresetBank& bank) { index = bank.indexOf(settings.presetName); });
+        if(! processor.recallPreset(index))
+        {
+            error = "No preset named " + settings.presetName;
+            return false;
+        }
+    }
+
+    for(auto& id : settings.parameters.getAllKeys())
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        if(parameter == nullptr)
+        {
+            error = "Unknown parameter: " + id;
+            return false;
+        }
+
+        // Choices take their name ("24", "Mid/Side") as well as their index
+        parameter->setValueNotifyingHost(parameter->getValueForText(settings.parameters[id]));
+    }
+
+    automationCursors.clear();
+    for(auto& lane : settings.automation.lanes)
+    {
+        auto* parameter = processor.apvts.getParameter(lane.parameterID);
+        if(parameter == nullptr)
+        {
+            error = "Unknown automated parameter: " + lane.parameterID;
+            return false;
+        }
+        automationCursors.emplace_back(lane, *parameter);
+    }
+    return true;
+}
+
+juce::File OfflineRenderer::getOutputFile(const juce::File& outputDirectory, const juce::File& input)
+{
+    auto output = outputDirectory.getChildFile(input.getFileName());
+    if(output == input)
+        output = output.getSiblingFile(input.getFileNameWithoutExtension() + "_squeezed" + input.getFileExtension());
+
+    // Compressed formats are only read, their renders are written as WAV
+    if(! juce::StringArray { ".wav", ".aif", ".aiff", ".flac" }.contains(output.getFileExtension(), true))
+        output = output.withFileExtension("wav");
+
+    return output;
+}
+
+bool OfflineRenderer::prepareProcessor(int numChannels, double sampleRate, int blockSize)
+{
+    if(numChannels < 1 || numChannels > SqueezeFilterAudioProcessor::maxChannels)
+        return false;
+
+    auto layout = processor.getBusesLayout();
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    layout.inputBuses.getReference(0) = channelSet;
+    layout.outputBuses.getReference(0) = channelSet;
+    for(int bus = 1; bus < layout.inputBuses.size(); ++bus)
+        layout.inputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+
+    if(! processor.setBusesLayout(layout))
+        return false;
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader> OfflineRenderer::createReader(const juce::File& input, bool& isMapped)
+{
+    // WAV and AIFF can be read straight out of a mapping, which skips the file reads and the
+    // decoder's staging buffer; everything else goes through the normal streaming reader
+    if(auto* format = formatManager.findFormatForFileExtension(input.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(input));
+        if(mapped != nullptr && mapped->mapEntireFile())
+        {
+            isMapped = true;
+            return mapped;
+        }
+    }
+
+    isMapped = false;
+    return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(input));
+}
+
+void OfflineRenderer::processBlock(juce::AudioBuffer<float>& buffer, juce::int64 startSample, double sampleRate,
+                                   const std::function<void(int start, int numSamples)>& onPeriod)
+{
+    juce::MidiBuffer midi;
+
+    if(automationCursors.empty())
+    {
+        processor.processBlock(buffer, midi);
+        onPeriod(0, buffer.getNumSamples());
+        return;
+    }
+
+    // One processor block per control period with the parameters set at its start, exactly
+    // what a realtime host running at that buffer size would do with the same automation
+    const auto controlRate = settings.automation.controlRate;
+    for(int start = 0; start < buffer.getNumSamples(); start += controlRate)
+    {
+        const auto time = static_cast<double>(startSample + start) / sampleRate;
+        for(auto& cursor : automationCursors)
+            cursor.apply(time);
+
+        const auto numSamples = juce::jmin(controlRate, buffer.getNumSamples() - start);
+        juce::AudioBuffer<float> period(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+        processor.processBlock(period, midi);
+        // An automated response type can leave the morph grid waiting on a rebuild
+        processor.runPendingMessageThreadWork();
+        onPeriod(start, numSamples);
+    }
+}
+
+RenderResult OfflineRenderer::render(const juce::File& input)
+{
+    RenderResult result;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    bool isMapped = false;
+    auto reader = createReader(input, isMapped);
+    if(reader == nullptr)
+    {
+        result.error = "Cannot read " + input.getFullPathName();
+        return result;
+    }
+
+    const auto numChannels = static_cast<int>(reader->numChannels);
+
+    // A mapped file is converted and filtered a cache-sized tile at a time, so the samples are
+    // still in cache when the filter reaches them. Tiles stay a multiple of the modulation step.
+    auto blockSize = settings.blockSize;
+    if(isMapped)
+        blockSize = juce::jlimit(1024, juce::jmax(1024, blockSize), (tileBytes / (numChannels * (int) sizeof(float))) & ~31);
+
+    // Whole control periods per block, so where the parameters change does not depend on it
+    const auto controlRate = settings.automation.controlRate;
+    if(! automationCursors.empty())
+        blockSize = (blockSize + controlRate - 1) / controlRate * controlRate;
+
+    for(auto& cursor : automationCursors)
+        cursor.rewind();
+
+    if(! prepareProcessor(numChannels, reader->sampleRate, blockSize))
+    {
+        result.error = juce::String(numChannels) + " channels are not supported";
+        return result;
+    }
+    // The main thread runs no message loop while the workers render, this one stands in for it
+    processor.runPendingMessageThreadWork();
+
+    auto outputFile = getOutputFile(settings.outputDirectory, input);
+    auto* format = formatManager.findFormatForFileExtension(outputFile.getFileExtension());
+    if(format == nullptr)
+    {
+        result.error = "No writer for " + outputFile.getFileExtension();
+        return result;
+    }
+
+    auto bitDepth = static_cast<int>(reader->bitsPerSample);
+    if(! format->getPossibleBitDepths().contains(bitDepth))
+        bitDepth = 24;
+
+    outputFile.deleteFile();
+    auto stream = outputFile.createOutputStream();
+    std::unique_ptr<juce::AudioFormatWriter> fileWriter;
+    if(stream != nullptr)
+        fileWriter.reset(format->createWriterFor(stream.get(), reader->sampleRate, static_cast<unsigned int>(numChannels),
+                                                 bitDepth, reader->metadataValues, 0));
+    if(fileWriter == nullptr)
+    {
+        result.error = "Cannot write " + outputFile.getFullPathName();
+        return result;
+    }
+    stream.release(); // the writer owns it now
+
+    // Two blocks of room: the writer thread drains one while the next is being filtered
+    auto writer = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(fileWriter.release(), writerThread, 2 * blockSize);
+
+    const auto length = reader->lengthInSamples;
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    std::vector<const float*> channels(static_cast<size_t>(numChannels));
+
+    juce::int64 written = 0;
+    std::vector<float> lastSamples(static_cast<size_t>(numChannels));
+    auto write = [&](const juce::AudioBuffer<float>& source, int start, int numSamples)
+    {
+        numSamples = static_cast<int>(juce::jmin<juce::int64>(numSamples, length - written));
+        if(numSamples <= 0)
+            return;
+
+        for(int ch = 0; ch < numChannels; ++ch)
+            channels[(size_t) ch] = source.getReadPointer(ch, start);
+        // Only waits when the disk has fallen a whole block behind
+        while(! writer->write(channels.data(), numSamples))
+            juce::Thread::sleep(1);
+        written += numSamples;
+
+        for(int ch = 0; ch < numChannels; ++ch)
+            lastSamples[(size_t) ch] = source.getSample(ch, start + numSamples - 1);
+    };
+
+    // The pipelined cascade delays the output, and automation can switch it on and off mid-file.
+    // As much output is dropped as the current latency: added latency is dropped from the next
+    // period out, latency that goes away is made up by holding the last sample. The end is run
+    // through on silence until the file's length has been written.
+    int dropped = 0;
+    juce::AudioBuffer<float> held(numChannels, 0);
+    juce::int64 readPosition = 0;
+
+    while(written < length)
+    {
+        reader->read(&buffer, 0, blockSize, readPosition, true, true);
+        processBlock(buffer, readPosition, reader->sampleRate, [&](int start, int numSamples)
+        {
+            const auto latency = processor.getProcessingLatency();
+            if(latency < dropped)
+            {
+                held.setSize(numChannels, dropped - latency, false, false, true);
+                for(int ch = 0; ch < numChannels; ++ch)
+                    juce::FloatVectorOperations::fill(held.getWritePointer(ch), lastSamples[(size_t) ch], held.getNumSamples());
+                write(held, 0, held.getNumSamples());
+                dropped = latency;
+            }
+
+            const auto skip = juce::jlimit(0, numSamples, latency - dropped);
+            dropped += skip;
+            write(buffer, start + skip, numSamples - skip);
+        });
+        readPosition += blockSize;
+    }
+
+    // Flushes whatever the writer thread has not written yet
+    writer.reset();
+    result.telemetry = processor.getTelemetry();
+    result.inputLufs = processor.getInputLoudness().integrated;
+    result.outputLufs = processor.getOutputLoudness().integrated;
+    // Nothing has read the meters during the render, so they hold the peaks of the whole file
+    for(auto& levels : processor.readOutputLevels())
+    {
+        result.peakDb = juce::jmax(result.peakDb, levels.peak);
+        result.truePeakDb = juce::jmax(result.truePeakDb, levels.truePeak);
+    }
+    processor.releaseResources();
+
+    result.ok = true;
+    result.audioSeconds = static_cast<double>(length) / reader->sampleRate;
+    result.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    return result;
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "Automation.h"
+
+struct RenderSettings
+{
+    juce::File stateFile;                 // getStateInformation() blob or an XML preset, optional
+    juce::File presetBank;                // optional, the plugin's default bank otherwise
+    juce::String presetName;              // recalled after the state, before the parameters
+    juce::StringPairArray parameters;     // parameter id -> value in real units, applied after the state
+    juce::File outputDirectory;
+    int blockSize = 65536;
+    AutomationSet automation;
+};
+
+struct RenderResult
+{
+    bool ok = false;
+    juce::String error;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    TelemetrySnapshot telemetry;          // load per block against its duration at the file's rate
+    float peakDb = -100.0f, truePeakDb = -100.0f;   // of the output, over both shown channels
+    float inputLufs = -100.0f, outputLufs = -100.0f;  // integrated over the whole file
+
+    double getRealtimeMultiple() const { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+};
+
+/*
+ Runs files through a private SqueezeFilterAudioProcessor, so a render uses exactly the DSP
+ the plugin does. Audio streams through in fixed blocks, memory does not grow with the file
+ length. WAV and AIFF are memory mapped, and output goes to a writer thread so disk I/O
+ overlaps the filtering. One renderer per worker thread; it is reused from file to file.
+ */
+class OfflineRenderer
+{
+public:
+    explicit OfflineRenderer(const RenderSettings& settings);
+    ~OfflineRenderer();
+
+    // Loads the state file, parameter overrides and automation lanes, false with a message if
+    // they cannot be applied
+    bool loadParameters(juce::String& error);
+
+    // Time spent in setStateInformation() for a state blob, zero for XML presets
+    double getStateLoadMicroseconds() const { return processor.getLastStateLoadMicroseconds(); }
+    // What the processor's analyzer fifos hold, there is no editor here
+    juce::String getAnalyzerMemoryReport() const { return processor.getAnalyzerMemoryReport(); }
+
+    RenderResult render(const juce::File& input);
+
+    // Named after the input's file name alone, so main() checks no two inputs share one
+    static juce::File getOutputFile(const juce::File& outputDirectory, const juce::File& input);
+
+private:
+    RenderSettings settings;
+    juce::AudioFormatManager formatManager;
+    SqueezeFilterAudioProcessor processor;
+    juce::TimeSliceThread writerThread {"Render writer"};
+    std::vector<AutomationCursor> automationCursors;
+
+    // Roughly a per-core L2, for the tile size of memory mapped input
+    static constexpr int tileBytes = 256 * 1024;
+
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& input, bool& isMapped);
+    bool prepareProcessor(int numChannels, double sampleRate, int blockSize);
+    // Calls onPeriod for each stretch processed with one set of parameters, the whole block
+    // without automation, so its samples can be written out at the latency they came out with
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::int64 startSample, double sampleRate,
+                      const std::function<void(int start, int numSamples)>& onPeriod);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
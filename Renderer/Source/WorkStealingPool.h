@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ Runs a fixed set of jobs on a few worker threads. Jobs are dealt out round robin up front;
+ a worker takes from the front of its own queue and, once that is empty, steals from the
+ back of the others, so one long file does not leave the rest of the cores idle. Each job
+ is handed its worker index so it can use per-worker state such as a processor instance.
+ */
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void(int workerIndex)>;
+
+    explicit WorkStealingPool(int numWorkers)
+    {
+        for(int i = 0; i < juce::jmax(1, numWorkers); ++i)
+            workers.add(new Worker(*this, i));
+    }
+
+    int getNumWorkers() const { return workers.size(); }
+
+    void add(Job job)
+    {
+        auto& worker = *workers[nextWorker];
+        nextWorker = (nextWorker + 1) % workers.size();
+
+        const juce::ScopedLock lock(worker.queueLock);
+        worker.queue.push_back(std::move(job));
+    }
+
+    // Returns once every job added so far has finished
+    void runAll()
+    {
+        for(auto* worker : workers)
+            worker->startThread();
+        for(auto* worker : workers)
+            worker->waitForThreadToExit(-1);
+    }
+
+private:
+    struct Worker : public juce::Thread
+    {
+        Worker(WorkStealingPool& p, int i) : juce::Thread("Render worker " + juce::String(i)), pool(p), index(i) {}
+
+        void run() override
+        {
+            while(auto job = pool.takeJob(index))
+                job(index);
+        }
+
+        WorkStealingPool& pool;
+        const int index;
+
+        juce::CriticalSection queueLock;
+        std::deque<Job> queue;
+    };
+
+    Job takeJob(int workerIndex)
+    {
+        {
+            auto& own = *workers[workerIndex];
+            const juce::ScopedLock lock(own.queueLock);
+            if(! own.queue.empty())
+            {
+                auto job = std::move(own.queue.front());
+                own.queue.pop_front();
+                return job;
+            }
+        }
+
+        for(int k = 1; k < workers.size(); ++k)
+        {
+            auto& victim = *workers[(workerIndex + k) % workers.size()];
+            const juce::ScopedLock lock(victim.queueLock);
+            if(! victim.queue.empty())
+            {
+                auto job = std::move(victim.queue.back());
+                victim.queue.pop_back();
+                return job;
+            }
+        }
+        return {};
+    }
+
+    juce::OwnedArray<Worker> workers;
+    int nextWorker = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkStealingPool)
+};
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    AnalyzerBudget.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ How big the analyzer's buffers get, worked out from a per instance memory budget instead of
+ fixed 30 slot queues of whole FFT frames and host sized blocks. Queues are kept shallow, since
+ the editor only ever draws the newest frame, and every slot is allocated once and reused.
+
+ The processor side is two sample fifos of small fixed chunks, deep enough to ride out two
+ editor frames. Whatever the budget leaves goes to the editor's two path producers, which get
+ the largest FFT that fits. At the default 256 KB that is 2048 points.
+ */
+struct AnalyzerBudget
+{
+    static constexpr size_t defaultBytes = 256 * 1024;
+
+    // Samples per slot in the processor's fifos, independent of the host's block size
+    static constexpr int sampleChunk = 512;
+    static constexpr double editorFrameRate = 60.0;
+    // Slots in the FFT and path queues; an AbstractFifo keeps one free, so one frame waits
+    static constexpr int frameQueueSlots = 2;
+    static constexpr int minOrder = 11, maxOrder = 14;
+    // A line to every this many FFT bins, as AnalyzerPathGenerator draws it
+    static constexpr int pathResolution = 2;
+
+    static int getSampleQueueSlots(double sampleRate)
+    {
+        const auto samplesPerFrame = (sampleRate > 0.0 ? sampleRate : 48000.0) / editorFrameRate;
+        return static_cast<int>(std::ceil(2.0 * samplesPerFrame / sampleChunk)) + 1;
+    }
+
+    // One SingleChannelSampleFifo: its slots and the chunk being filled
+    static size_t getSampleFifoBytes(double sampleRate)
+    {
+        return static_cast<size_t>(getSampleQueueSlots(sampleRate) + 1) * sampleChunk * sizeof(float);
+    }
+
+    static size_t getPathBytes(int order)
+    {
+        // Three floats per line to
+        return static_cast<size_t>((1 << order) / 2 / pathResolution + 1) * 3 * sizeof(float);
+    }
+
+    // One PathProducer. The FFT engine's own tables are not visible from outside, they are
+    // counted as 2 floats per point, which is what JUCE's fallback engine keeps.
+    static size_t getProducerBytes(int order)
+    {
+        const auto n = static_cast<size_t>(1) << order;
+        const auto frame = n / 2 * sizeof(float);
+        const auto workspace = 2 * n * sizeof(float);
+        const auto window = n * sizeof(float), history = n * sizeof(float), engine = 2 * n * sizeof(float);
+        const auto incoming = static_cast<size_t>(sampleChunk) * sizeof(float);
+        // Queued paths, the one drawn and the one being generated
+        const auto paths = static_cast<size_t>(frameQueueSlots + 2) * getPathBytes(order);
+
+        return workspace + frame * (frameQueueSlots + 1) + window + history + engine + incoming + paths;
+    }
+
+    // The largest order whose two producers fit next to both sample fifos, minOrder at least
+    static int chooseOrder(size_t budgetBytes, double sampleRate)
+    {
+        const auto fifoBytes = 2 * getSampleFifoBytes(sampleRate);
+        for(int order = maxOrder; order > minOrder; --order)
+            if(fifoBytes + 2 * getProducerBytes(order) <= budgetBytes)
+                return order;
+        return minOrder;
+    }
+};
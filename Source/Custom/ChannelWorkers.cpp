@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    ChannelWorkers.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkers.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <time.h>
+ #include <cerrno>
+#endif
+
+#if JUCE_WINDOWS
+
+struct WakeSignal::Native
+{
+    HANDLE semaphore = CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr);
+    ~Native() { CloseHandle(semaphore); }
+
+    void signal() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait(int timeoutMs) noexcept { WaitForSingleObject(semaphore, static_cast<DWORD>(timeoutMs)); }
+};
+
+#elif JUCE_MAC || JUCE_IOS
+
+struct WakeSignal::Native
+{
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    ~Native() { dispatch_release(semaphore); }
+
+    void signal() noexcept { dispatch_semaphore_signal(semaphore); }
+    void wait(int timeoutMs) noexcept
+    {
+        dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(timeoutMs) * NSEC_PER_MSEC));
+    }
+};
+
+#else
+
+struct WakeSignal::Native
+{
+    sem_t semaphore;
+    Native() { sem_init(&semaphore, 0, 0); }
+    ~Native() { sem_destroy(&semaphore); }
+
+    void signal() noexcept { sem_post(&semaphore); }
+    void wait(int timeoutMs) noexcept
+    {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+        if(deadline.tv_nsec >= 1000000000L)
+        {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        // A signal or the timeout ends the wait, an interrupt just waits again
+        while(sem_timedwait(&semaphore, &deadline) != 0 && errno == EINTR) {}
+    }
+};
+
+#endif
+
+WakeSignal::WakeSignal() : native(std::make_unique<Native>()) {}
+WakeSignal::~WakeSignal() = default;
+
+void WakeSignal::signal() noexcept { native->signal(); }
+void WakeSignal::wait(int timeoutMs) noexcept { native->wait(timeoutMs); }
@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    ChannelWorkers.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_MAJOR_VERSION > 7 || (JUCE_MAJOR_VERSION == 7 && (JUCE_MINOR_VERSION > 0 || JUCE_BUILDNUMBER >= 7))
+ #define SQUEEZE_HAS_AUDIO_WORKGROUP 1
+#else
+ #define SQUEEZE_HAS_AUDIO_WORKGROUP 0
+#endif
+
+/*
+ A counting semaphore on the platform's own primitive: sem_t, a dispatch semaphore or a
+ Win32 semaphore. Signalling is an atomic increment plus a kernel wake when someone waits,
+ never a mutex, so the audio thread can use it. juce::WaitableEvent locks a mutex to signal.
+ */
+class WakeSignal
+{
+public:
+    WakeSignal();
+    ~WakeSignal();
+
+    void signal() noexcept;
+    // Returns early on a signal, including one given before the wait started
+    void wait(int timeoutMs) noexcept;
+
+private:
+    struct Native;
+    std::unique_ptr<Native> native;
+
+    JUCE_DECLARE_NON_COPYABLE (WakeSignal)
+};
+
+/*
+ A few realtime threads that share out the independent tasks of one audio callback, here the
+ channel groups of a wide bus. The audio thread publishes a job, takes tasks itself alongside
+ the workers and returns once every task has finished. Tasks are claimed with a compare and
+ swap on a word holding both the job number and the next task, so a worker still finishing
+ the previous job can never pick up part of the next one by mistake.
+
+ Workers spin for a short while after each job so back to back callbacks find them awake,
+ then sleep until the next job. The audio thread never allocates or locks, and only signals a
+ worker's semaphore when that worker has gone to sleep after an idle spell.
+ */
+class ChannelWorkers
+{
+public:
+    ~ChannelWorkers() { stop(); }
+
+    // Message thread, from prepareToPlay/releaseResources
+    void start(int numWorkers)
+    {
+        stop();
+        for(int i = 0; i < numWorkers; ++i)
+        {
+            auto* worker = workers.add(new Worker(*this));
+            worker->startRealtimeThread(juce::Thread::RealtimeOptions{});
+        }
+    }
+
+    void stop()
+    {
+        for(auto* worker : workers)
+            worker->signalThreadShouldExit();
+        for(auto* worker : workers)
+        {
+            worker->wake.signal();
+            worker->stopThread(1000);
+        }
+        workers.clear();
+    }
+
+    int getNumWorkers() const { return workers.size(); }
+
+   #if SQUEEZE_HAS_AUDIO_WORKGROUP
+    // The host's workgroup for the audio thread; workers join it before their next job
+    void setWorkgroup(const juce::AudioWorkgroup& newWorkgroup)
+    {
+        {
+            const juce::SpinLock::ScopedLockType lock(workgroupLock);
+            workgroup = newWorkgroup;
+        }
+        ++workgroupGeneration;
+    }
+   #endif
+
+    // Audio thread: runs task(i) for every i below numTasks and returns when all are done
+    template<typename Task>
+    void run(int numTasks, Task& task) noexcept
+    {
+        if(workers.isEmpty() || numTasks <= 1)
+        {
+            for(int i = 0; i < numTasks; ++i)
+                task(i);
+            return;
+        }
+
+        invoke = [](void* context, int index) { (*static_cast<Task*>(context))(index); };
+        context = &task;
+        jobSize.store(numTasks, std::memory_order_relaxed);
+        remaining.store(numTasks, std::memory_order_relaxed);
+
+        // Store then load here, store then load in the worker: only seq_cst on all four keeps
+        // both sides from reading the old value, and a worker sleeping through the job
+        const auto job = static_cast<std::uint64_t>(++jobNumber);
+        claim.store(job << 32, std::memory_order_seq_cst);
+
+        for(auto* worker : workers)
+            if(worker->isSleeping.load(std::memory_order_seq_cst))
+                worker->wake.signal();
+
+        runTasks(job);
+
+        while(remaining.load(std::memory_order_acquire) > 0)
+            pause();
+    }
+
+private:
+    struct Worker : public juce::Thread
+    {
+        explicit Worker(ChannelWorkers& o) : juce::Thread("Squeeze channel worker"), owner(o) {}
+
+        void run() override
+        {
+            std::uint64_t lastJob = 0;
+            int idleSpins = 0;
+           #if SQUEEZE_HAS_AUDIO_WORKGROUP
+            juce::WorkgroupToken token;
+            int joinedGeneration = -1;
+           #endif
+
+            while(! threadShouldExit())
+            {
+               #if SQUEEZE_HAS_AUDIO_WORKGROUP
+                if(joinedGeneration != owner.workgroupGeneration.load())
+                {
+                    joinedGeneration = owner.workgroupGeneration.load();
+                    token.reset();
+                    const juce::SpinLock::ScopedLockType lock(owner.workgroupLock);
+                    if(owner.workgroup)
+                        owner.workgroup.join(token);
+                }
+               #endif
+
+                const auto job = owner.claim.load(std::memory_order_acquire) >> 32;
+                if(job != lastJob)
+                {
+                    lastJob = job;
+                    owner.runTasks(job);
+                    idleSpins = 0;
+                    continue;
+                }
+
+                if(++idleSpins < maxIdleSpins)
+                {
+                    pause();
+                    continue;
+                }
+
+                // Checked again after saying we are asleep, a job published in between still wakes us
+                isSleeping.store(true, std::memory_order_seq_cst);
+                if((owner.claim.load(std::memory_order_seq_cst) >> 32) == lastJob)
+                    wake.wait(100);
+                isSleeping.store(false, std::memory_order_release);
+                idleSpins = 0;
+            }
+        }
+
+        ChannelWorkers& owner;
+        WakeSignal wake;
+        std::atomic<bool> isSleeping {false};
+    };
+
+    // Roughly a millisecond of spinning, several callbacks' worth at small buffer sizes
+    static constexpr int maxIdleSpins = 20000;
+
+    juce::OwnedArray<Worker> workers;
+
+    // Upper 32 bits: job number, lower 32 bits: next task of that job
+    std::atomic<std::uint64_t> claim {0};
+    std::atomic<int> remaining {0};
+    std::uint32_t jobNumber = 0;
+    void (*invoke)(void*, int) = nullptr;
+    void* context = nullptr;
+    std::atomic<int> jobSize {0};
+
+   #if SQUEEZE_HAS_AUDIO_WORKGROUP
+    juce::SpinLock workgroupLock;
+    juce::AudioWorkgroup workgroup;
+    std::atomic<int> workgroupGeneration {0};
+   #endif
+
+    void runTasks(std::uint64_t job) noexcept
+    {
+        auto current = claim.load(std::memory_order_acquire);
+        for(;;)
+        {
+            if((current >> 32) != job)
+                return;
+
+            const auto index = static_cast<int>(current & 0xffffffffu);
+            if(index >= jobSize.load(std::memory_order_relaxed))
+                return;
+
+            if(! claim.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel))
+                continue;
+
+            invoke(context, index);
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+            current = claim.load(std::memory_order_acquire);
+        }
+    }
+
+    static void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (JUCE_MAC || JUCE_IOS || JUCE_LINUX)
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelWorkers)
+};
@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    CutDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "CutDesign.h"
+
+using namespace juce;
+using Design = juce::dsp::FilterDesign<float>;
+
+static constexpr float passbandAmplitudedB = -0.5f;
+
+static float getSlopeAttenuation(Slope slope)
+{
+    switch(slope)
+    {
+        case Slope_72: return 72.0f;
+        case Slope_96: return 96.0f;
+        default: return 12.0f * (slope + 1);
+    }
+}
+
+static Design::IIRCoefficientsArray designLowpass(ResponseType type, float passbandEdge, float stopbandEdge, double sampleRate, float attenuation)
+{
+    // FilterDesign takes the middle of the transition band and its width
+    const auto centre = (passbandEdge + stopbandEdge) * 0.5f;
+    const auto width = (stopbandEdge - passbandEdge) / static_cast<float>(sampleRate);
+    
+    switch(type)
+    {
+        case ChebyshevI:  return Design::designIIRLowpassHighOrderChebyshev1Method(centre, sampleRate, width, passbandAmplitudedB, -attenuation);
+        case ChebyshevII: return Design::designIIRLowpassHighOrderChebyshev2Method(centre, sampleRate, width, passbandAmplitudedB, -attenuation);
+        case Elliptic:    return Design::designIIRLowpassHighOrderEllipticMethod(centre, sampleRate, width, passbandAmplitudedB, -attenuation);
+        case Butterworth:
+        case AutoTarget:
+        default:          return Design::designIIRLowpassHighOrderButterworthMethod(centre, sampleRate, width, passbandAmplitudedB, -attenuation);
+    }
+}
+
+static int designCut(CutSections& sections, ResponseType type, bool isHighPass, float frequency,
+                     double sampleRate, float attenuation, float distance)
+{
+    const auto nyquist = static_cast<float>(sampleRate * 0.5);
+    float passbandEdge, stopbandEdge;
+    
+    if(isHighPass)
+    {
+        // FilterDesign only has low passes, so design the mirror image around a quarter of the
+        // sample rate and flip it back with z -> -z below
+        passbandEdge = nyquist - frequency;
+        stopbandEdge = nyquist - frequency * std::pow(2.0f, -distance);
+    }
+    else
+    {
+        passbandEdge = frequency;
+        stopbandEdge = jmin(frequency * std::pow(2.0f, distance), nyquist * 0.98f);
+    }
+    
+    if(stopbandEdge <= passbandEdge)
+        return 0;
+    
+    auto design = designLowpass(type, passbandEdge, stopbandEdge, sampleRate, attenuation);
+    if(design.size() > maxCutSections)
+        return 0;
+    
+    for(int i = 0; i < design.size(); ++i)
+    {
+        const auto& c = design.getObjectPointer(i)->coefficients;
+        auto& section = sections[(size_t) i];
+        
+        if(c.size() == 3)
+            section = { c[0], c[1], 0.0f, c[2], 0.0f };
+        else
+            section = { c[0], c[1], c[2], c[3], c[4] };
+        
+        if(isHighPass)
+        {
+            section.b1 = -section.b1;
+            section.a1 = -section.a1;
+        }
+    }
+    return design.size();
+}
+
+int designSpecCutSections(CutSections& sections, bool isHighPass, float frequency, const DesignSpec& spec)
+{
+    const auto slope = isHighPass ? spec.lowCutSlope : spec.highCutSlope;
+    int numSections = 0;
+    
+    if(spec.type == AutoTarget)
+    {
+        // Cheapest type wins, ties go to the one listed first since its passband is smoother
+        CutSections candidate;
+        for(auto type : { Butterworth, ChebyshevII, ChebyshevI, Elliptic })
+        {
+            auto n = designCut(candidate, type, isHighPass, frequency, spec.sampleRate, spec.targetAttenuation, spec.targetDistance);
+            if(n > 0 && (numSections == 0 || n < numSections))
+            {
+                numSections = n;
+                sections = candidate;
+            }
+        }
+    }
+    else if(spec.type != Butterworth)
+    {
+        numSections = designCut(sections, spec.type, isHighPass, frequency, spec.sampleRate, getSlopeAttenuation(slope), 1.0f);
+    }
+    
+    // Out of reach within maxCutSections, or plain Butterworth
+    if(numSections == 0)
+        numSections = designCutSections(sections, isHighPass, frequency, spec.sampleRate, spec.type == Butterworth ? slope : Slope_96);
+    
+    return numSections;
+}
+
+//==============================================================================
+static float getGridFrequency(int index)
+{
+    return 20.0f * std::pow(2.0f, float(index) / float(CutDesignTable::pointsPerOctave));
+}
+
+CutDesignTable::CutDesignTable(const DesignSpec& specToBuild) : spec(specToBuild)
+{
+    for(int i = 0; i < numPoints; ++i)
+    {
+        auto freq = jmin(getGridFrequency(i), static_cast<float>(spec.sampleRate * 0.45));
+        numLowCutSections[(size_t) i] = designSpecCutSections(lowCutSections[(size_t) i], true, freq, spec);
+        numHighCutSections[(size_t) i] = designSpecCutSections(highCutSections[(size_t) i], false, freq, spec);
+    }
+}
+
+static BiquadCoefficients interpolate(const BiquadCoefficients& from, const BiquadCoefficients& to, float t) noexcept
+{
+    return { from.b0 + t * (to.b0 - from.b0), from.b1 + t * (to.b1 - from.b1), from.b2 + t * (to.b2 - from.b2),
+             from.a1 + t * (to.a1 - from.a1), from.a2 + t * (to.a2 - from.a2) };
+}
+
+int CutDesignTable::lookup(CutSections& sections, bool isHighPass, float frequency) const noexcept
+{
+    const auto position = jlimit(0.0f, static_cast<float>(numPoints - 1), std::log2(jmax(frequency, 20.0f) / 20.0f) * pointsPerOctave);
+    const auto below = jmin(static_cast<int>(position), numPoints - 2);
+    const auto t = position - static_cast<float>(below);
+    
+    const auto& designs = isHighPass ? lowCutSections : highCutSections;
+    const auto& counts = isHighPass ? numLowCutSections : numHighCutSections;
+    const auto numSections = counts[(size_t) below];
+    
+    if(numSections != counts[(size_t) below + 1])
+    {
+        const auto nearest = (size_t) (t < 0.5f ? below : below + 1);
+        sections = designs[nearest];
+        return counts[nearest];
+    }
+    
+    for(int k = 0; k < numSections; ++k)
+        sections[(size_t) k] = interpolate(designs[(size_t) below][(size_t) k], designs[(size_t) below + 1][(size_t) k], t);
+    return numSections;
+}
+
+//==============================================================================
+struct CutDesignCache::Worker
+{
+    Worker() { thread.startThread(); }
+    ~Worker() { thread.stopThread(2000); }
+
+    juce::TimeSliceThread thread {"Cut design cache"};
+};
+
+CutDesignCache::CutDesignCache()
+{
+    worker->thread.addTimeSliceClient(this);
+}
+
+CutDesignCache::~CutDesignCache()
+{
+    // Waits for a table being built for this cache
+    worker->thread.removeTimeSliceClient(this);
+    releaseRetiredTables();
+    delete pending.exchange(nullptr);
+    delete active;
+}
+
+const CutDesignTable* CutDesignCache::getTable(const DesignSpec& spec) noexcept
+{
+    if(! hasRequested || spec != lastRequested)
+    {
+        auto write = requestFifo.write(1);
+        if(write.blockSize1 > 0)
+        {
+            requests[(size_t) write.startIndex1] = spec;
+            lastRequested = spec;
+            hasRequested = true;
+        }
+    }
+    
+    if(auto* ready = pending.exchange(nullptr))
+    {
+        if(active != nullptr)
+        {
+            auto write = retiredFifo.write(1);
+            if(write.blockSize1 > 0)
+                retired[(size_t) write.startIndex1] = active;
+            else
+                jassertfalse; // the background thread has stopped collecting, this leaks
+        }
+        active = ready;
+    }
+    
+    return active != nullptr && active->spec == spec ? active : nullptr;
+}
+
+const CutDesignTable* CutDesignCache::waitForTable(const DesignSpec& spec, int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+    
+    auto* table = getTable(spec);
+    while(table == nullptr && juce::Time::getMillisecondCounter() < deadline)
+    {
+        worker->thread.moveToFrontOfQueue(this);
+        juce::Thread::sleep(1);
+        table = getTable(spec);
+    }
+    return table;
+}
+
+void CutDesignCache::releaseRetiredTables()
+{
+    while(retiredFifo.getNumReady() > 0)
+    {
+        auto read = retiredFifo.read(1);
+        if(read.blockSize1 > 0)
+            delete retired[(size_t) read.startIndex1];
+    }
+}
+
+int CutDesignCache::useTimeSlice()
+{
+    releaseRetiredTables();
+    
+    // Only the newest request matters, older ones are already out of date
+    std::optional<DesignSpec> latest;
+    while(requestFifo.getNumReady() > 0)
+    {
+        auto read = requestFifo.read(1);
+        if(read.blockSize1 > 0)
+            latest = requests[(size_t) read.startIndex1];
+    }
+    
+    if(! latest.has_value())
+        return 100;
+    
+    if(latest->type != Butterworth)
+    {
+        auto table = std::make_unique<CutDesignTable>(*latest);
+        
+        // A table the audio thread never picked up can go straight away
+        delete pending.exchange(table.release());
+    }
+    
+    // Back soon, the audio thread may still be settling on a spec
+    return 20;
+}
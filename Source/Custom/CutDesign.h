@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    CutDesign.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+
+enum ResponseType
+{
+    Butterworth,
+    ChebyshevI,
+    ChebyshevII,
+    Elliptic,
+    AutoTarget
+};
+
+inline juce::StringArray getResponseTypeNames()
+{
+    return { "Butterworth", "Chebyshev I", "Chebyshev II", "Elliptic", "Auto" };
+}
+
+/*
+ What a non Butterworth cut has to achieve. The fixed types take their steepness from the
+ slope choice, read as that many dB of attenuation one octave past the cutoff. AutoTarget
+ uses the target attenuation and distance and picks whichever type needs fewest sections.
+ The fields a type doesn't use are left at their defaults, so equal specs mean equal designs.
+ */
+struct DesignSpec
+{
+    ResponseType type {ResponseType::Butterworth};
+    Slope lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
+    float targetAttenuation {60.0f};   // dB
+    float targetDistance {0.5f};       // octaves from the cutoff
+    double sampleRate {44100.0};
+
+    bool operator== (const DesignSpec& other) const
+    {
+        return type == other.type
+            && lowCutSlope == other.lowCutSlope && highCutSlope == other.highCutSlope
+            && targetAttenuation == other.targetAttenuation && targetDistance == other.targetDistance
+            && sampleRate == other.sampleRate;
+    }
+    bool operator!= (const DesignSpec& other) const { return ! operator==(other); }
+};
+
+// Designs one cut directly with FilterDesign. Allocates, so never call it on the audio thread.
+int designSpecCutSections(CutSections& sections, bool isHighPass, float frequency, const DesignSpec& spec);
+
+/*
+ One spec designed on a log spaced grid of cutoffs, 1/24 octave apart. A lookup blends the
+ sections of the two grid points either side, so a modulated cutoff moves smoothly rather
+ than in 1/24 octave steps. Linear blends of two stable biquads stay stable. Where the order
+ changes between the two points there is nothing to pair up, and the nearer design is used.
+ */
+struct CutDesignTable
+{
+    static constexpr int pointsPerOctave = 24;
+    static constexpr int numPoints = 10 * pointsPerOctave + 1;   // 20 Hz to 20 kHz and a bit
+
+    explicit CutDesignTable(const DesignSpec& specToBuild);
+
+    int lookup(CutSections& sections, bool isHighPass, float frequency) const noexcept;
+
+    const DesignSpec spec;
+
+private:
+    std::array<CutSections, numPoints> lowCutSections, highCutSections;
+    std::array<int, numPoints> numLowCutSections {}, numHighCutSections {};
+};
+
+/*
+ Builds design tables in the background. The audio thread asks for a spec every block and
+ gets the matching table once it is ready, or nullptr in the meantime. New tables are handed
+ over through an atomic pointer and the ones the audio thread drops are sent back through a
+ FIFO, so only the background thread ever allocates or frees them.
+
+ Every instance is a client of one shared TimeSliceThread, so a session with hundreds of
+ tracks has one design thread, not hundreds. Idle caches are polled less often.
+ */
+class CutDesignCache : private juce::TimeSliceClient
+{
+public:
+    CutDesignCache();
+    ~CutDesignCache() override;
+
+    const CutDesignTable* getTable(const DesignSpec& spec) noexcept;
+    // Blocks until the table is built, for offline renders that must not hear the fallback
+    const CutDesignTable* waitForTable(const DesignSpec& spec, int timeoutMs = 5000);
+
+private:
+    struct Worker;
+    juce::SharedResourcePointer<Worker> worker;
+
+    int useTimeSlice() override;
+    void releaseRetiredTables();
+
+    // Audio thread only
+    CutDesignTable* active = nullptr;
+    DesignSpec lastRequested;
+    bool hasRequested = false;
+
+    std::atomic<CutDesignTable*> pending {nullptr};
+
+    static constexpr int fifoSize = 16;
+    juce::AbstractFifo requestFifo {fifoSize};
+    std::array<DesignSpec, fifoSize> requests;
+    juce::AbstractFifo retiredFifo {fifoSize};
+    std::array<CutDesignTable*, fifoSize> retired {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CutDesignCache)
+};
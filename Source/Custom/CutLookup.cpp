@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    CutLookup.cpp
+
+  ==============================================================================
+*/
+
+#include "CutLookup.h"
+
+static constexpr double minFrequency = 20.0;
+static constexpr double maxFrequency = 20000.0;
+
+std::shared_ptr<const CutLookupTables> CutLookupTables::getForSampleRate(double sampleRate)
+{
+    static juce::CriticalSection lock;
+    static std::map<double, std::weak_ptr<const CutLookupTables>> tables;
+
+    const juce::ScopedLock scopedLock(lock);
+    auto& entry = tables[sampleRate];
+    auto shared = entry.lock();
+    if(shared == nullptr)
+    {
+        shared = std::make_shared<const CutLookupTables>(sampleRate);
+        entry = shared;
+    }
+    return shared;
+}
+
+CutLookupTables::CutLookupTables(double rate) : sampleRate(rate)
+{
+    // Rates too low for the whole range keep a short table, designCutSections covers the rest
+    const auto top = juce::jmin(maxFrequency, 0.45 * sampleRate);
+    minPosition = getPosition(minFrequency);
+    maxPosition = getPosition(top);
+    numPoints = juce::jmax(2, static_cast<int>(std::ceil((maxPosition - minPosition) * pointsPerOctave)) + 1);
+    pointsPerUnit = (numPoints - 1) / (maxPosition - minPosition);
+
+    lowCutPoints.resize((size_t) numPoints * sectionsPerPoint);
+    highCutPoints.resize((size_t) numPoints * sectionsPerPoint);
+
+    for(int p = 0; p < numPoints; ++p)
+    {
+        const auto frequency = static_cast<float>(getFrequency(minPosition + p / pointsPerUnit));
+        for(int slope = Slope_12; slope <= Slope_96; ++slope)
+        {
+            const auto first = (size_t) p * sectionsPerPoint + (size_t) getFirstSection(static_cast<Slope>(slope));
+            CutSections sections;
+
+            const auto numLowCut = designCutSections(sections, true, frequency, sampleRate, static_cast<Slope>(slope));
+            std::copy_n(sections.begin(), numLowCut, lowCutPoints.begin() + (std::ptrdiff_t) first);
+
+            const auto numHighCut = designCutSections(sections, false, frequency, sampleRate, static_cast<Slope>(slope));
+            std::copy_n(sections.begin(), numHighCut, highCutPoints.begin() + (std::ptrdiff_t) first);
+        }
+    }
+}
+
+int CutLookupTables::getFirstSection(Slope slope) noexcept
+{
+    switch(slope)
+    {
+        case Slope_72: return 4;
+        case Slope_96: return 10;
+        default: return static_cast<int>(slope);
+    }
+}
+
+double CutLookupTables::getPosition(double frequency) const noexcept
+{
+    return std::log2(std::tan(juce::MathConstants<double>::pi * frequency / sampleRate));
+}
+
+double CutLookupTables::getFrequency(double position) const noexcept
+{
+    return std::atan(std::exp2(position)) * sampleRate / juce::MathConstants<double>::pi;
+}
+
+int CutLookupTables::lookup(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept
+{
+    const auto position = getPosition(frequency);
+    if(position < minPosition || position > maxPosition)
+        return designCutSections(sections, isHighPass, frequency, sampleRate, slope);
+
+    const auto x = (position - minPosition) * pointsPerUnit;
+    const auto index = juce::jmin(static_cast<int>(x), numPoints - 2);
+    const auto t = static_cast<float>(x - index);
+
+    const auto numSections = isSteep(slope) ? getButterworthOrder(slope) / 2 : 1;
+    const auto& points = isHighPass ? lowCutPoints : highCutPoints;
+    auto* a = points.data() + (size_t) index * sectionsPerPoint + (size_t) getFirstSection(slope);
+    auto* b = a + sectionsPerPoint;
+
+    for(int k = 0; k < numSections; ++k)
+    {
+        auto& c = sections[(size_t) k];
+        c.b0 = a[k].b0 + t * (b[k].b0 - a[k].b0);
+        c.b1 = a[k].b1 + t * (b[k].b1 - a[k].b1);
+        c.b2 = a[k].b2 + t * (b[k].b2 - a[k].b2);
+        c.a1 = a[k].a1 + t * (b[k].a1 - a[k].a1);
+        c.a2 = a[k].a2 + t * (b[k].a2 - a[k].a2);
+    }
+    return numSections;
+}
+
+size_t CutLookupTables::getMemoryBytes() const
+{
+    return sizeof(*this) + (lowCutPoints.size() + highCutPoints.size()) * sizeof(BiquadCoefficients);
+}
+
+double CutLookupTables::measureMaxErrorDb() const
+{
+    constexpr int numProbes = 64;
+    const auto top = juce::jmin(22000.0, 0.499 * sampleRate);
+    const auto threshold = juce::Decibels::decibelsToGain(-60.0);
+
+    double worst = 0.0;
+    for(int slope = Slope_12; slope <= Slope_96; ++slope)
+    {
+        for(auto isHighPass : { true, false })
+        {
+            for(int p = 0; p + 1 < numPoints; ++p)
+            {
+                const auto frequency = static_cast<float>(getFrequency(minPosition + (p + 0.5) / pointsPerUnit));
+
+                CutSections exact, interpolated;
+                const auto numExact = designCutSections(exact, isHighPass, frequency, sampleRate, static_cast<Slope>(slope));
+                const auto numInterpolated = lookup(interpolated, isHighPass, frequency, static_cast<Slope>(slope));
+                jassert(numExact == numInterpolated);
+
+                for(int i = 0; i < numProbes; ++i)
+                {
+                    const auto probe = 10.0 * std::pow(top / 10.0, i / (numProbes - 1.0));
+                    double exactGain = 1.0, interpolatedGain = 1.0;
+                    for(int k = 0; k < numExact; ++k)
+                    {
+                        exactGain *= getMagnitudeForFrequency(exact[(size_t) k], probe, sampleRate);
+                        interpolatedGain *= getMagnitudeForFrequency(interpolated[(size_t) k], probe, sampleRate);
+                    }
+
+                    if(exactGain > threshold)
+                        worst = juce::jmax(worst, std::abs(juce::Decibels::gainToDecibels(interpolatedGain / exactGain, -200.0)));
+                }
+            }
+        }
+    }
+    return worst;
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    CutLookup.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+
+/*
+ Every Butterworth section designCutSections produces, for every slope, on a dense grid of
+ cutoffs at one sample rate. A lookup blends the two nearest grid points section by section,
+ which stays stable for the same reason the morph grid does.
+
+ The grid is uniform in log(tan(pi f / fs)) rather than log f. The coefficients are rational
+ in that prewarped frequency, so the spacing tightens towards Nyquist where they change
+ fastest and the interpolation error comes out the same everywhere: about 0.02 dB at 32
+ points per octave, against roughly 0.6 dB for a plain log f grid at 44.1 kHz.
+ */
+class CutLookupTables
+{
+public:
+    static constexpr int pointsPerOctave = 32;
+
+    // Shared by every instance running at this rate, built by the first one to ask.
+    // Message thread, from prepareToPlay.
+    static std::shared_ptr<const CutLookupTables> getForSampleRate(double sampleRate);
+
+    explicit CutLookupTables(double sampleRate);
+
+    // Same sections and count as designCutSections, falling back to it outside 20 Hz - 20 kHz
+    int lookup(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept;
+
+    double getSampleRate() const { return sampleRate; }
+    int getNumPoints() const { return numPoints; }
+    size_t getMemoryBytes() const;
+
+    // Worst magnitude difference in dB between a lookup and the direct design, taken halfway
+    // between grid points down to -60 dB of the response. Runs every slope, so not realtime.
+    double measureMaxErrorDb() const;
+
+private:
+    // 1 section each for 12-48 dB/oct, 6 for 72 and 8 for 96
+    static constexpr int sectionsPerPoint = 18;
+    static int getFirstSection(Slope slope) noexcept;
+
+    double sampleRate;
+    double minPosition = 0.0, maxPosition = 0.0, pointsPerUnit = 0.0;
+    int numPoints = 0;
+    std::vector<BiquadCoefficients> lowCutPoints, highCutPoints;   // numPoints * sectionsPerPoint
+
+    double getPosition(double frequency) const noexcept;
+    double getFrequency(double position) const noexcept;
+};
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    DiagnosticLog.cpp
+
+  ==============================================================================
+*/
+
+#include "DiagnosticLog.h"
+
+std::atomic<bool> DiagnosticLog::enabled { juce::SystemStats::getEnvironmentVariable("SQUEEZE_LOG", {}).getIntValue() != 0 };
+std::atomic<int> DiagnosticLog::instanceCounter {0};
+
+// Record times are printed from when the plugin was loaded
+static const juce::int64 originTicks = juce::Time::getHighResolutionTicks();
+
+struct DiagnosticLog::Writer
+{
+    ~Writer()
+    {
+        thread.stopThread(1000);
+    }
+
+    void start()
+    {
+        const juce::ScopedLock sl(lock);
+        if(! thread.isThreadRunning())
+            thread.startThread();
+    }
+
+    // Opened with the first thing to write, so a plugin that never logs never touches the file
+    juce::FileLogger& getLogger()
+    {
+        const juce::ScopedLock sl(lock);
+        if(logger == nullptr)
+            logger.reset(juce::FileLogger::createDefaultAppLogger("SqueezeFilter", "Diagnostics.txt", "SqueezeFilter diagnostics"));
+        return *logger;
+    }
+
+    juce::CriticalSection lock;
+    std::unique_ptr<juce::FileLogger> logger;
+    juce::TimeSliceThread thread {"Diagnostic log"};
+};
+
+DiagnosticLog::DiagnosticLog() : instanceId(++instanceCounter)
+{
+    writer->thread.addTimeSliceClient(this);
+    if(isEnabled())
+        writer->start();
+}
+
+void DiagnosticLog::setEnabled(bool shouldBeEnabled)
+{
+    enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+    if(shouldBeEnabled)
+        juce::SharedResourcePointer<Writer>()->start();
+}
+
+DiagnosticLog::~DiagnosticLog()
+{
+    // Waits for a slice in progress, then writes what is left from this thread
+    writer->thread.removeTimeSliceClient(this);
+    useTimeSlice();
+}
+
+void DiagnosticLog::log(LogEvent event, float a, float b, int value) noexcept
+{
+    if(! isEnabled())
+        return;
+
+    const auto scope = fifo.write(1);
+    if(scope.blockSize1 > 0)
+        records[(size_t) scope.startIndex1] = { juce::Time::getHighResolutionTicks(), event, value, a, b };
+    else
+        numDropped.store(numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+juce::String DiagnosticLog::format(const LogRecord& record)
+{
+    auto text = juce::String(juce::Time::highResolutionTicksToSeconds(record.ticks - originTicks), 6) + " s  ";
+    auto hz = [](float frequency) { return juce::String(frequency, 1) + " Hz"; };
+
+    switch(record.event)
+    {
+        case LogEvent::Prepared:
+            return text + "prepared at " + hz(record.a) + ", blocks up to " + juce::String(record.value);
+        case LogEvent::Redesigned:
+            return text + "coefficients redesigned: low cut " + hz(record.a) + ", high cut " + hz(record.b)
+                        + ", " + juce::String(record.value) + " sections";
+        case LogEvent::CutoffClamp:
+            return text + (record.value != 0 ? "side " : "") + "low cut above high cut, holding "
+                        + hz(record.a) + " - " + hz(record.b);
+        case LogEvent::PathChanged:
+            return text + "path changed to " + juce::StringArray { "channel", "pipeline", "multiband" }[record.value]
+                        + (record.a != 0.0f ? " (preset recall)" : "");
+        case LogEvent::AnalyzerFifoFull:
+            return text + "analyzer fifo full, " + juce::String(record.value) + " buffers dropped so far";
+    }
+    return text + "unknown event " + juce::String(static_cast<int>(record.event));
+}
+
+int DiagnosticLog::useTimeSlice()
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+    const auto dropped = numDropped.load(std::memory_order_relaxed);
+
+    // Nothing is logged while logging is off, so nothing is written either
+    if(scope.blockSize1 + scope.blockSize2 == 0 && dropped == numDroppedReported)
+        return 250;
+
+    const auto prefix = "[" + juce::String(instanceId) + "] ";
+    auto& logger = writer->getLogger();
+    auto write = [&](int start, int size)
+    {
+        for(int i = start; i < start + size; ++i)
+            logger.logMessage(prefix + format(records[(size_t) i]));
+    };
+    write(scope.startIndex1, scope.blockSize1);
+    write(scope.startIndex2, scope.blockSize2);
+
+    if(dropped != numDroppedReported)
+    {
+        logger.logMessage(prefix + juce::String(dropped - numDroppedReported) + " records dropped, the ring was full");
+        numDroppedReported = dropped;
+    }
+
+    // Quiet instances are polled less often
+    return scope.blockSize1 > 0 ? 50 : 250;
+}
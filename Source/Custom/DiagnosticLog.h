@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    DiagnosticLog.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+enum class LogEvent : juce::uint16
+{
+    Prepared,           // a = sample rate, value = maximum block size
+    Redesigned,         // a = low cut Hz, b = high cut Hz, value = number of sections
+    CutoffClamp,        // lowCut went above highCut, a/b = the cutoffs held instead, value = 1 for the side chain
+    PathChanged,        // value = PathKind, a = 1 when the fade was forced by a preset recall
+    AnalyzerFifoFull    // value = buffers dropped so far
+};
+
+// Fixed size, so writing one is a copy into the ring
+struct LogRecord
+{
+    juce::int64 ticks;
+    LogEvent event;
+    juce::int32 value;
+    float a, b;
+};
+
+/*
+ Diagnostics from the audio thread, where DBG cannot be used. Events go into a per instance
+ single producer ring as LogRecords, never allocating or blocking; a full ring drops them and
+ counts how many. A thread shared by every instance turns them into text for
+ Logs/SqueezeFilter/Diagnostics.txt (FileLogger's default app log). The thread is started, and
+ the file opened, only once logging has been switched on.
+
+ Compiled into release builds as well and switched at runtime, by the SQUEEZE_LOG environment
+ variable or setEnabled(). Switched off, log() is one relaxed atomic load.
+ */
+class DiagnosticLog : private juce::TimeSliceClient
+{
+public:
+    DiagnosticLog();
+    ~DiagnosticLog() override;
+
+    static void setEnabled(bool shouldBeEnabled);
+    static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // One writing thread at a time: the audio thread, or prepareToPlay while it is stopped
+    void log(LogEvent event, float a = 0.0f, float b = 0.0f, int value = 0) noexcept;
+
+    static juce::String format(const LogRecord& record);
+
+private:
+    struct Writer;
+    juce::SharedResourcePointer<Writer> writer;
+
+    static std::atomic<bool> enabled;
+    static std::atomic<int> instanceCounter;
+    const int instanceId;
+
+    static constexpr int capacity = 1024;
+    std::array<LogRecord, capacity> records;
+    juce::AbstractFifo fifo {capacity};
+    std::atomic<juce::uint32> numDropped {0};
+    juce::uint32 numDroppedReported = 0;
+
+    int useTimeSlice() override;
+};
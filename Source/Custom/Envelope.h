@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Envelope.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+enum EnvelopeMode
+{
+    Peak,
+    Rms
+};
+
+inline juce::StringArray getEnvelopeModeNames()
+{
+    return { "Peak", "RMS" };
+}
+
+// Four independent accumulators, which leaves the compiler free to auto-vectorise the loop
+inline float sumOfSquares(const float* data, int numSamples)
+{
+    float sums[4] {};
+    int i = 0;
+
+    for(; i + 4 <= numSamples; i += 4)
+        for(int k = 0; k < 4; ++k)
+            sums[k] += data[i + k] * data[i + k];
+
+    for(; i < numSamples; ++i)
+        sums[0] += data[i] * data[i];
+
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+/*
+ Follows the sidechain level one sub-block at a time. Each sub-block of every channel is
+ reduced to a single peak (FloatVectorOperations) or sum of squares, and the channels are
+ combined into one level. The attack/release smoothing is plain scalar code, run once per
+ sub-block instead of once per sample, so there is one envelope for all channels.
+ */
+struct EnvelopeFollower
+{
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset()
+    {
+        envelope = 0.0f;
+    }
+
+    void setParameters(float newAttackMs, float newReleaseMs, EnvelopeMode newMode)
+    {
+        attackMs = newAttackMs;
+        releaseMs = newReleaseMs;
+        mode = newMode;
+    }
+
+    // Returns the smoothed level in decibels after consuming numSamples from startSample
+    float process(const juce::AudioBuffer<float>& sidechain, int startSample, int numSamples)
+    {
+        float level = 0.0f;
+        const auto numChannels = sidechain.getNumChannels();
+
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = sidechain.getReadPointer(ch, startSample);
+
+            if(mode == EnvelopeMode::Peak)
+            {
+                auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+                level = juce::jmax(level, -range.getStart(), range.getEnd());
+            }
+            else
+            {
+                level += sumOfSquares(data, numSamples);
+            }
+        }
+
+        if(mode == EnvelopeMode::Rms && numChannels > 0)
+            level = std::sqrt(level / float(numChannels * numSamples));
+
+        auto coefficient = getCoefficient(level > envelope ? attackMs : releaseMs, numSamples);
+        envelope = level + coefficient * (envelope - level);
+
+        return juce::Decibels::gainToDecibels(envelope, -100.0f);
+    }
+
+private:
+    double sampleRate = 44100.0;
+    float attackMs = 10.0f, releaseMs = 150.0f;
+    EnvelopeMode mode = EnvelopeMode::Peak;
+    float envelope = 0.0f;
+
+    float getCoefficient(float timeMs, int numSamples) const
+    {
+        return std::exp(-float(numSamples) / (timeMs * 0.001f * float(sampleRate)));
+    }
+};
@@ -9,14 +9,30 @@
 #pragma once
 
 #include <array>
+#include "Trace.h"
+#include "AnalyzerBudget.h"
 
+/*
+ Every slot is allocated when the fifo is prepared and reused from then on: push and pull copy
+ into storage of the same size, which never reallocates. How many slots there are is set per
+ fifo, the analyzer keeps them shallow (see AnalyzerBudget).
+ */
 template<typename T>
 struct Fifo
 {
-    void prepare(int numChannels, int numSamples)
+    // Not while anything is pushing or pulling. The AbstractFifo keeps one slot free.
+    void setNumSlots(int numSlots)
+    {
+        jassert(numSlots >= 2);
+        buffers.resize(static_cast<size_t>(numSlots));
+        fifo.setTotalSize(numSlots);
+    }
+    
+    void prepare(int numChannels, int numSamples, int numSlots = defaultNumSlots)
     {
         static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
                       "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
+        setNumSlots(numSlots);
         for( auto& buffer : buffers)
         {
             buffer.setSize(numChannels,
@@ -28,10 +44,11 @@ struct Fifo
         }
     }
     
-    void prepare(size_t numElements)
+    void prepare(size_t numElements, int numSlots = defaultNumSlots)
     {
         static_assert( std::is_same_v<T, std::vector<float>>,
                       "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
+        setNumSlots(numSlots);
         for( auto& buffer : buffers )
         {
             buffer.clear();
@@ -63,14 +80,56 @@ struct Fifo
         return false;
     }
     
+    // Trade t for a slot instead of copying, for types whose copy allocates (juce::Path). t
+    // comes back holding what the slot held before, its storage included.
+    bool pushBySwap(T& t)
+    {
+        auto write = fifo.write(1);
+        if( write.blockSize1 > 0 )
+        {
+            std::swap(buffers[write.startIndex1], t);
+            return true;
+        }
+        
+        return false;
+    }
+    
+    bool pullBySwap(T& t)
+    {
+        auto read = fifo.read(1);
+        if( read.blockSize1 > 0 )
+        {
+            std::swap(buffers[read.startIndex1], t);
+            return true;
+        }
+        
+        return false;
+    }
+    
     int getNumAvailableForReading() const
     {
         return fifo.getNumReady();
     }
+    
+    int getNumSlots() const { return fifo.getTotalSize(); }
+    
+    // What the slots hold. A path's points are not visible from here, only its object is counted.
+    size_t getMemoryBytes() const
+    {
+        auto bytes = sizeof(T) * buffers.size();
+        for( const auto& buffer : buffers )
+        {
+            if constexpr (std::is_same_v<T, juce::AudioBuffer<float>>)
+                bytes += static_cast<size_t>(buffer.getNumChannels() * buffer.getNumSamples()) * sizeof(float);
+            else if constexpr (std::is_same_v<T, std::vector<float>>)
+                bytes += buffer.capacity() * sizeof(float);
+        }
+        return bytes;
+    }
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
+    static constexpr int defaultNumSlots = 30;
+    std::vector<T> buffers = std::vector<T>(defaultNumSlots);
+    juce::AbstractFifo fifo {defaultNumSlots};
 };
 
 enum Channel
@@ -90,17 +149,40 @@ struct SingleChannelSampleFifo
     
     void update(const BlockType& buffer)
     {
-        jassert(prepared.get());
         jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        update(buffer.getReadPointer(channelToUse), buffer.getNumSamples());
+    }
+    
+    // For feeding the analyzer a tile at a time, straight after the tile is filtered
+    void update(const float* data, int numSamples)
+    {
+        SQUEEZE_TRACE_SCOPE("SingleChannelSampleFifo::update");
+        jassert(prepared.get());
+        const auto capacity = bufferToFill.getNumSamples();
+        if( capacity == 0 )
+            return;
         
-        for( int i = 0; i < buffer.getNumSamples(); ++i )
+        while( numSamples > 0 )
         {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            if( fifoIndex == capacity )
+            {
+                // Full whenever nothing pulls, e.g. with the editor closed; the buffer is dropped
+                if(! audioBufferFifo.push(bufferToFill))
+                    numOverflows.store(numOverflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                fifoIndex = 0;
+            }
+            
+            auto numToCopy = juce::jmin(numSamples, capacity - fifoIndex);
+            juce::FloatVectorOperations::copy(bufferToFill.getWritePointer(0, fifoIndex), data, numToCopy);
+            fifoIndex += numToCopy;
+            data += numToCopy;
+            numSamples -= numToCopy;
         }
     }
 
-    void prepare(int bufferSize)
+    // Buffers are bufferSize samples whatever the host's block size, update() splits and joins
+    // blocks to fit, so a huge offline block does not grow the analyzer
+    void prepare(int bufferSize, int numSlots)
     {
         prepared.set(false);
         size.set(bufferSize);
@@ -110,7 +192,7 @@ struct SingleChannelSampleFifo
                              false,         //keepExistingContent
                              true,          //clear extra space
                              true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
+        audioBufferFifo.prepare(1, bufferSize, numSlots);
         fifoIndex = 0;
         prepared.set(true);
     }
@@ -118,6 +200,13 @@ struct SingleChannelSampleFifo
     int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    // Buffers dropped because the fifo was full, since construction
+    juce::uint64 getNumOverflows() const { return numOverflows.load(std::memory_order_relaxed); }
+    // Not while the audio thread is preparing it
+    size_t getMemoryBytes() const
+    {
+        return audioBufferFifo.getMemoryBytes() + static_cast<size_t>(bufferToFill.getNumSamples()) * sizeof(float);
+    }
     //==============================================================================
     bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
 private:
@@ -127,19 +216,5 @@ private:
     BlockType bufferToFill;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
+    std::atomic<juce::uint64> numOverflows {0};
 };
@@ -10,12 +10,48 @@
 
 using namespace juce;
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double& lastLowCut, double& lastHighCut){
-  
+ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    ChainParameters parameters;
+    parameters.lowCut = apvts.getRawParameterValue("hp")->load();
+    parameters.highCut = apvts.getRawParameterValue("lp")->load();
+    parameters.squeeze = apvts.getRawParameterValue("SqueezeValue")->load();
+    parameters.offset = apvts.getRawParameterValue("OffsetValue")->load();
+    parameters.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCutSlope")->load());
+    parameters.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCutSlope")->load());
+    return parameters;
+}
+
+ChainParameters getSideChainParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    auto parameters = getChainParameters(apvts);
+    parameters.squeeze = apvts.getRawParameterValue("SideSqueeze")->load();
+    parameters.offset = apvts.getRawParameterValue("SideOffset")->load();
+    return parameters;
+}
+
+ChainSettings makeChainSettings(const ChainParameters& parameters, double& lastLowCut, double& lastHighCut, const ChainModulation& modulation)
+{
+    // Modulation moves the knobs, so the mapping below treats it exactly like a manual change
+    const auto squeezeValue = std::clamp(parameters.squeeze + modulation.squeeze, 0.0001f, 1.0f);
+    const auto offset = std::clamp(parameters.offset + modulation.offset, -19980.0f, 19980.0f);
+    const double lowCutFreq = std::clamp(parameters.lowCut + modulation.lowCut, 20.0f, 20000.0f);
+    const double highCutFreq = std::clamp(parameters.highCut + modulation.highCut, 20.0f, 20000.0f);
+    
+    return makeChainSettings(lowCutFreq, highCutFreq, squeezeValue, offset,
+                             parameters.lowCutSlope, parameters.highCutSlope,
+                             lastLowCut, lastHighCut);
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double& lastLowCut, double& lastHighCut, const ChainModulation& modulation)
+{
+    return makeChainSettings(getChainParameters(apvts), lastLowCut, lastHighCut, modulation);
+}
+
+ChainSettings makeChainSettings(double lowCutFreq, double highCutFreq, float squeezeValue, float offset,
+                                Slope lowCutSlope, Slope highCutSlope, double& lastLowCut, double& lastHighCut)
+{
     ChainSettings settings;
-    float offset = apvts.getRawParameterValue("OffsetValue")->load();
-    double lowCutFreq = apvts.getRawParameterValue("hp")->load();
-    double highCutFreq = apvts.getRawParameterValue("lp")->load();
 
     double minValue = 20.0;
     double maxValue = 20000.0;
@@ -28,14 +64,13 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double
        // Apply exponential mapping
     double convertedHighCutValue = minValue * std::pow(maxValue / minValue, normalizedHighCutValue);
     highCutFreq = convertedHighCutValue;
-    
-    auto squeezeValue = apvts.getRawParameterValue("SqueezeValue")->load();
 
     //Clamp double Slider
     if(lowCutFreq > highCutFreq)
     {
         highCutFreq = lastHighCut;
         lowCutFreq = lastLowCut;
+        settings.cutoffsClamped = true;
     }
         lastHighCut = highCutFreq;
         lastLowCut = lowCutFreq;
@@ -61,8 +96,106 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double
     // Clamp the values to the valid range
     settings.lowCutFreq = std::clamp(settings.lowCutFreq, 20.f, 20000.0f);
     settings.highCutFreq = std::clamp(settings.highCutFreq, 20.0f, 20000.f);
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCutSlope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCutSlope")->load());
+    settings.lowCutSlope = lowCutSlope;
+    settings.highCutSlope = highCutSlope;
         
     return settings;
 }
+
+BiquadCoefficients makeButterworthSection(bool isHighPass, float frequency, double sampleRate, int order, int sectionIndex)
+{
+    // Mirrors FilterDesign::designIIR...HighOrderButterworthMethod and the IIR::Coefficients
+    // factories it calls: an odd order starts with a first order section, the rest are
+    // second order sections with increasing Q.
+    BiquadCoefficients c;
+    const auto w = MathConstants<float>::pi * frequency / static_cast<float>(sampleRate);
+    
+    if(order % 2 == 1 && sectionIndex == 0)
+    {
+        const auto n = std::tan(w);
+        const auto invA0 = 1.0f / (n + 1.0f);
+        c.b0 = isHighPass ? invA0 : n * invA0;
+        c.b1 = isHighPass ? -invA0 : n * invA0;
+        c.a1 = (n - 1.0f) * invA0;
+        return c;
+    }
+    
+    const auto q = order % 2 == 1
+        ? static_cast<float>(1.0 / (2.0 * std::cos(sectionIndex * MathConstants<double>::pi / order)))
+        : static_cast<float>(1.0 / (2.0 * std::cos((2.0 * sectionIndex + 1.0) * MathConstants<double>::pi / (order * 2.0))));
+    const auto invQ = 1.0f / q;
+    
+    if(isHighPass)
+    {
+        const auto n = std::tan(w);
+        const auto nSquared = n * n;
+        const auto c1 = 1.0f / (1.0f + invQ * n + nSquared);
+        c.b0 = c1;
+        c.b1 = c1 * -2.0f;
+        c.b2 = c1;
+        c.a1 = c1 * 2.0f * (nSquared - 1.0f);
+        c.a2 = c1 * (1.0f - invQ * n + nSquared);
+    }
+    else
+    {
+        const auto n = 1.0f / std::tan(w);
+        const auto nSquared = n * n;
+        const auto c1 = 1.0f / (1.0f + invQ * n + nSquared);
+        c.b0 = c1;
+        c.b1 = c1 * 2.0f;
+        c.b2 = c1;
+        c.a1 = c1 * 2.0f * (1.0f - nSquared);
+        c.a2 = c1 * (1.0f - invQ * n + nSquared);
+    }
+    return c;
+}
+
+int designCutSections(CutSections& sections, bool isHighPass, float frequency, double sampleRate, Slope slope)
+{
+    const auto order = getButterworthOrder(slope);
+    
+    if(! isSteep(slope))
+    {
+        sections[0] = makeButterworthSection(isHighPass, frequency, sampleRate, order, slope);
+        return 1;
+    }
+    
+    const auto numSections = order / 2;
+    jassert(numSections <= maxCutSections);
+    for(int i = 0; i < numSections; ++i)
+        sections[(size_t) i] = makeButterworthSection(isHighPass, frequency, sampleRate, order, i);
+    
+    return numSections;
+}
+
+double getMagnitudeForFrequency(const BiquadCoefficients& section, double frequency, double sampleRate)
+{
+    const auto w = MathConstants<double>::twoPi * frequency / sampleRate;
+    const std::complex<double> z1 = std::polar(1.0, -w);
+    const std::complex<double> z2 = z1 * z1;
+    
+    auto numerator = (double) section.b0 + (double) section.b1 * z1 + (double) section.b2 * z2;
+    auto denominator = 1.0 + (double) section.a1 * z1 + (double) section.a2 * z2;
+    return std::abs(numerator / denominator);
+}
+
+double getRingOutSamples(const BiquadCoefficients& c, double decayDb)
+{
+    // Poles are the roots of z^2 + a1 z + a2
+    const double a1 = c.a1, a2 = c.a2;
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+    
+    double radius;
+    if(discriminant < 0.0)
+        radius = std::sqrt(a2);
+    else
+        radius = 0.5 * (std::abs(a1) + std::sqrt(discriminant));
+    
+    // Two samples of state even for a section with no feedback
+    if(radius <= 0.0)
+        return 2.0;
+    
+    // -ln(r) >= 1 - r, so this errs long and needs no log, it runs per modulation sub-block
+    radius = std::min(radius, 1.0 - 1.0e-9);
+    return 2.0 + decayDb * (std::log(10.0) / 20.0) / (1.0 - radius);
+}
@@ -14,82 +14,103 @@ enum Slope
     Slope_12,
     Slope_24,
     Slope_36,
-    Slope_48
+    Slope_48,
+    Slope_72,
+    Slope_96
 };
 
+// 12-48 run the single resonant section of a 2n+1 order design, 72 and 96 a full Butterworth cascade
+inline bool isSteep(Slope slope) { return slope >= Slope_72; }
+
+inline int getButterworthOrder(Slope slope)
+{
+    switch(slope)
+    {
+        case Slope_72: return 12;
+        case Slope_96: return 16;
+        default: return 2 * slope + 1;
+    }
+}
+
 struct ChainSettings
 {
     float lowCutFreq {0}, highCutFreq{0};
     Slope lowCutSlope{Slope::Slope_12}, highCutSlope{Slope::Slope_12};
+    // lowCut went above highCut and the last cutoffs were held instead
+    bool cutoffsClamped {false};
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double& lastLowCut, double& lastHighCut );
+// Added on top of the SqueezeValue/OffsetValue and hp/lp parameters before they are mapped to
+// cutoffs, squeeze in 0-1 parameter units, the rest in Hz. Sums are clamped to the parameter ranges.
+// Morph moves the MorphPosition parameter, in its 0-1 units.
+struct ChainModulation
+{
+    float squeeze {0}, offset {0};
+    float lowCut {0}, highCut {0};
+    float morph {0};
 
+    bool isZero() const { return squeeze == 0.0f && offset == 0.0f && lowCut == 0.0f && highCut == 0.0f && morph == 0.0f; }
 
-using Filter = juce::dsp::IIR::Filter<float>;
-//CREATE 4 filters for the different slopes
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-//LowCut, HighCut
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, CutFilter>;
+    ChainModulation scaled(float amount) const
+    {
+        return { squeeze * amount, offset * amount, lowCut * amount, highCut * amount, morph * amount };
+    }
 
+    ChainModulation operator+ (const ChainModulation& other) const
+    {
+        return { squeeze + other.squeeze, offset + other.offset, lowCut + other.lowCut, highCut + other.highCut, morph + other.morph };
+    }
+};
 
-enum ChainPositions
+enum StereoMode
 {
-    LowCut,
-    HighCut,
+    Stereo,
+    MidSide
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
+inline juce::StringArray getStereoModeNames()
 {
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
+    return { "Stereo", "Mid/Side" };
 }
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType &leftLowCut, const CoefficientType& cutCoefficients, const Slope &lowCutSlope)
+// The knob values getChainSettings maps to cutoffs: hp/lp in their linear 20-20000 parameter
+// units, squeeze and offset as the parameters hold them
+struct ChainParameters
 {
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
-    
-    switch(lowCutSlope)
-    {
-        case Slope_48:
-        {
-            update<3>(leftLowCut, cutCoefficients);
-           
-            break;
-        }
-        case Slope_36:
-        {
-            update<2>(leftLowCut, cutCoefficients);
-            break;
-        }
-        case Slope_24:
-        {
-            update<1>(leftLowCut, cutCoefficients);
-            break;
-        }
-        case Slope_12:
-        {
-            update<0>(leftLowCut, cutCoefficients);
-            break;
-        }
-    }
-}
+    float lowCut {20.0f}, highCut {20000.0f};
+    float squeeze {1.0f}, offset {0.0f};
+    Slope lowCutSlope {Slope::Slope_24}, highCutSlope {Slope::Slope_24};
+};
+
+ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& apvts);
+// SideSqueeze/SideOffset in place of SqueezeValue/OffsetValue
+ChainParameters getSideChainParameters(juce::AudioProcessorValueTreeState& apvts);
+
+ChainSettings makeChainSettings(const ChainParameters& parameters, double& lastLowCut, double& lastHighCut, const ChainModulation& modulation = {});
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, double& lastLowCut, double& lastHighCut, const ChainModulation& modulation = {});
+
+ChainSettings makeChainSettings(double lowCutParam, double highCutParam, float squeezeValue, float offset,
+                                Slope lowCutSlope, Slope highCutSlope, double& lastLowCut, double& lastHighCut);
 
-inline auto makeLowCutFilter(const ChainSettings chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope) + 1);
-}
 
-inline auto makeHighCutFilter(const ChainSettings chainSettings, double sampleRate)
+// One normalised (a0 == 1) filter section. First order sections leave b2 and a2 at zero.
+struct BiquadCoefficients
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope) + 1);
-}
+    float b0 {1}, b1 {0}, b2 {0}, a1 {0}, a2 {0};
+};
+
+// Section 'sectionIndex' of the Butterworth design FilterDesign would produce for 'order',
+// computed without allocating so it can run on the audio thread.
+BiquadCoefficients makeButterworthSection(bool isHighPass, float frequency, double sampleRate, int order, int sectionIndex);
+
+static constexpr int maxCutSections = 8;
+using CutSections = std::array<BiquadCoefficients, maxCutSections>;
+
+// Every section a cut runs for its slope, in processing order. Returns how many are used.
+int designCutSections(CutSections& sections, bool isHighPass, float frequency, double sampleRate, Slope slope);
+
+// Samples for the section's impulse response to fall by decayDb, set by its slowest pole
+double getRingOutSamples(const BiquadCoefficients& c, double decayDb = 120.0);
+
+double getMagnitudeForFrequency(const BiquadCoefficients& section, double frequency, double sampleRate);
@@ -0,0 +1,367 @@
+/*
+  ==============================================================================
+
+    LaneFilter.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+
+using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+/*
+ A filter section that runs one independent biquad per SIMD lane. Each lane has its own
+ coefficients and state, so a lane can be a band, a channel or anything else that shares
+ the same section layout. Transposed direct form II, the same as IIR::Filter.
+ */
+struct LaneBiquad
+{
+    SIMDFloat b0 = SIMDFloat::expand(1.0f);
+    SIMDFloat b1 = SIMDFloat::expand(0.0f);
+    SIMDFloat b2 = SIMDFloat::expand(0.0f);
+    SIMDFloat a1 = SIMDFloat::expand(0.0f);
+    SIMDFloat a2 = SIMDFloat::expand(0.0f);
+
+    SIMDFloat s1 = SIMDFloat::expand(0.0f);
+    SIMDFloat s2 = SIMDFloat::expand(0.0f);
+
+    void setLane(size_t lane, const BiquadCoefficients& c) noexcept
+    {
+        b0.set(lane, c.b0);
+        b1.set(lane, c.b1);
+        b2.set(lane, c.b2);
+        a1.set(lane, c.a1);
+        a2.set(lane, c.a2);
+    }
+
+    void setAllLanes(const BiquadCoefficients& c) noexcept
+    {
+        b0 = SIMDFloat::expand(c.b0);
+        b1 = SIMDFloat::expand(c.b1);
+        b2 = SIMDFloat::expand(c.b2);
+        a1 = SIMDFloat::expand(c.a1);
+        a2 = SIMDFloat::expand(c.a2);
+    }
+
+    void reset() noexcept
+    {
+        s1 = SIMDFloat::expand(0.0f);
+        s2 = SIMDFloat::expand(0.0f);
+    }
+
+    SIMDFloat processSample(SIMDFloat x) noexcept
+    {
+        auto y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+// Passes the lane through unchanged
+static constexpr BiquadCoefficients identitySection {};
+// Outputs silence, used to mute lanes that are not in use
+static constexpr BiquadCoefficients silentSection { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+/*
+ Up to MaxLanes lanes each running the same number of sections, packed into as few SIMD
+ registers as possible. Every lane gets the same input sample and the lane outputs are
+ summed, which is what a band split followed by a mix needs. Lanes past MaxLanes only pad
+ out the last register and are left out of the sum.
+ */
+template<size_t MaxLanes, size_t MaxSections>
+struct LaneCascade
+{
+    static constexpr size_t numRegisters = (MaxLanes + SIMDFloat::size() - 1) / SIMDFloat::size();
+    static constexpr size_t numPaddingLanes = numRegisters * SIMDFloat::size() - MaxLanes;
+
+    LaneCascade()
+    {
+        for(size_t lane = 0; lane < SIMDFloat::size(); ++lane)
+            liveLanes.set(lane, lane + numPaddingLanes < SIMDFloat::size() ? 1.0f : 0.0f);
+    }
+
+    void setSection(size_t lane, size_t section, const BiquadCoefficients& c) noexcept
+    {
+        jassert(lane < MaxLanes && section < MaxSections);
+        sections[lane / SIMDFloat::size()][section].setLane(lane % SIMDFloat::size(), c);
+    }
+
+    void setNumSections(size_t newNumSections) noexcept
+    {
+        jassert(newNumSections <= MaxSections);
+        numSections = newNumSections;
+    }
+
+    void reset() noexcept
+    {
+        for(auto& group : sections)
+            for(auto& section : group)
+                section.reset();
+    }
+
+    float processSampleSummed(float x) noexcept
+    {
+        auto input = SIMDFloat::expand(x);
+        auto total = SIMDFloat::expand(0.0f);
+
+        for(size_t r = 0; r < numRegisters; ++r)
+        {
+            auto v = input;
+            for(size_t k = 0; k < numSections; ++k)
+                v = sections[r][k].processSample(v);
+
+            // The padding lanes still run (as identity sections) but must not reach the sum
+            if constexpr (numPaddingLanes > 0)
+                if(r == numRegisters - 1)
+                    v = v * liveLanes;
+            total += v;
+        }
+        return total.sum();
+    }
+
+private:
+    std::array<std::array<LaneBiquad, MaxSections>, numRegisters> sections;
+    size_t numSections = 0;
+    // 1 for the lanes of the last register that are in use, 0 for padding
+    SIMDFloat liveLanes = SIMDFloat::expand(1.0f);
+};
+
+/*
+ Runs a deep serial cascade with one section per SIMD lane. A plain cascade is bound by
+ latency because every section waits for the one before it; here lane k works on sample
+ n - k while lane k + 1 works on sample n - k - 1, so all sections of a register update
+ in the same instruction and only a one-lane shift links them. The price is a delay of
+ numSections - 1 samples, which the processor reports as latency.
+ */
+template<size_t MaxSections>
+struct PipelinedCascade
+{
+    static constexpr size_t lanesPerRegister = SIMDFloat::size();
+    static constexpr size_t numRegisters = (MaxSections + lanesPerRegister - 1) / lanesPerRegister;
+    static constexpr size_t numLanes = numRegisters * lanesPerRegister;
+
+    void setSection(size_t section, const BiquadCoefficients& c) noexcept
+    {
+        jassert(section < MaxSections);
+        sections[section / lanesPerRegister].setLane(section % lanesPerRegister, c);
+    }
+
+    // Changing the depth changes which sample each lane holds, so the pipeline starts over
+    void setNumSections(size_t newNumSections) noexcept
+    {
+        jassert(newNumSections > 0 && newNumSections <= MaxSections);
+        if(newNumSections == numSections)
+            return;
+
+        numSections = newNumSections;
+        for(auto k = numSections; k < numLanes; ++k)
+            setSection(k, identitySection);
+        reset();
+    }
+
+    int getLatency() const noexcept { return static_cast<int>(numSections) - 1; }
+
+    void reset() noexcept
+    {
+        for(auto& section : sections)
+            section.reset();
+        std::fill(std::begin(inputs), std::end(inputs), 0.0f);
+        std::fill(std::begin(outputs), std::end(outputs), 0.0f);
+    }
+
+    void process(float* data, int numSamples) noexcept
+    {
+        const auto activeRegisters = (numSections + lanesPerRegister - 1) / lanesPerRegister;
+        const auto last = numSections - 1;
+
+        for(int i = 0; i < numSamples; ++i)
+        {
+            inputs[0] = data[i];
+
+            for(size_t r = 0; r < activeRegisters; ++r)
+            {
+                auto y = sections[r].processSample(SIMDFloat::fromRawArray(inputs + r * lanesPerRegister));
+                y.copyToRawArray(outputs + r * lanesPerRegister);
+            }
+
+            data[i] = outputs[last];
+
+            // Each section's output becomes the next section's input on the next sample
+            std::copy(outputs, outputs + last, inputs + 1);
+        }
+    }
+
+private:
+    std::array<LaneBiquad, numRegisters> sections;
+    size_t numSections = 0;
+
+    alignas(sizeof(SIMDFloat)) float inputs[numLanes] {};
+    alignas(sizeof(SIMDFloat)) float outputs[numLanes] {};
+};
+
+/*
+ The main filter path: channels are packed into SIMD lanes, a register at a time, with the
+ state kept per lane so one instruction advances a section for a whole group of channels.
+ Each group is handled in tiles: a tile of its channels is interleaved into lane order, run
+ through every section, and written back, so wide layouts cost less per channel than running
+ one chain per channel.
+ */
+template<size_t MaxChannels, size_t MaxSections>
+struct ChannelCascade
+{
+    static constexpr size_t lanesPerRegister = SIMDFloat::size();
+    static constexpr size_t maxGroups = (MaxChannels + lanesPerRegister - 1) / lanesPerRegister;
+    static constexpr size_t tileSize = 64;
+
+    void setNumChannels(size_t newNumChannels) noexcept
+    {
+        jassert(newNumChannels <= MaxChannels);
+        numChannels = juce::jmin(newNumChannels, MaxChannels);
+        numGroups = (numChannels + lanesPerRegister - 1) / lanesPerRegister;
+        reset();
+    }
+
+    size_t getNumChannels() const noexcept { return numChannels; }
+
+    // Stereo only: lane 0 carries mid and lane 1 side, encoded on the way into the tile and
+    // decoded on the way out, so the M/S matrix costs no extra pass over the buffer
+    void setMidSide(bool shouldUseMidSide) noexcept
+    {
+        jassert(! shouldUseMidSide || numChannels == 2);
+        if(shouldUseMidSide == midSide)
+            return;
+
+        midSide = shouldUseMidSide;
+        reset();
+    }
+
+    // Same coefficients for every channel
+    void setSection(size_t section, const BiquadCoefficients& c) noexcept
+    {
+        jassert(section < MaxSections);
+        for(size_t g = 0; g < numGroups; ++g)
+            groups[g][section].setAllLanes(c);
+    }
+
+    void setSection(size_t section, size_t channel, const BiquadCoefficients& c) noexcept
+    {
+        jassert(section < MaxSections && channel < numChannels);
+        groups[channel / lanesPerRegister][section].setLane(channel % lanesPerRegister, c);
+    }
+
+    void setNumSections(size_t newNumSections) noexcept
+    {
+        jassert(newNumSections <= MaxSections);
+        numSections = newNumSections;
+    }
+
+    void reset() noexcept
+    {
+        for(auto& group : groups)
+            for(auto& section : group)
+                section.reset();
+    }
+
+    size_t getNumGroups() const noexcept { return numGroups; }
+
+    void process(juce::dsp::AudioBlock<float>& block) noexcept
+    {
+        for(size_t g = 0; g < numGroups; ++g)
+            processGroup(block, g);
+    }
+
+    // Groups share nothing, so separate threads may run different groups of the same block
+    void processGroup(juce::dsp::AudioBlock<float>& block, size_t g) noexcept
+    {
+        jassert(block.getNumChannels() >= numChannels && g < numGroups);
+        const auto numSamples = block.getNumSamples();
+        const auto firstChannel = g * lanesPerRegister;
+        const auto groupChannels = juce::jmin(lanesPerRegister, numChannels - firstChannel);
+        auto* tile = tiles[g].samples;
+        auto& sections = groups[g];
+
+        for(size_t start = 0; start < numSamples; start += tileSize)
+        {
+            const auto tileLength = juce::jmin(tileSize, numSamples - start);
+
+            if(midSide)
+                encodeMidSide(tile, block, start, tileLength);
+            else
+                interleave(tile, block, firstChannel, groupChannels, start, tileLength);
+
+            for(size_t i = 0; i < tileLength; ++i)
+            {
+                auto x = SIMDFloat::fromRawArray(tile + i * lanesPerRegister);
+                for(size_t k = 0; k < numSections; ++k)
+                    x = sections[k].processSample(x);
+                x.copyToRawArray(tile + i * lanesPerRegister);
+            }
+
+            if(midSide)
+                decodeMidSide(tile, block, start, tileLength);
+            else
+                deinterleave(tile, block, firstChannel, groupChannels, start, tileLength);
+        }
+    }
+
+private:
+    std::array<std::array<LaneBiquad, MaxSections>, maxGroups> groups;
+    size_t numChannels = 0, numGroups = 0, numSections = 0;
+    bool midSide = false;
+
+    static void interleave(float* tile, juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t groupChannels, size_t start, size_t tileLength) noexcept
+    {
+        for(size_t lane = 0; lane < groupChannels; ++lane)
+        {
+            auto* channel = block.getChannelPointer(firstChannel + lane) + start;
+            for(size_t i = 0; i < tileLength; ++i)
+                tile[i * lanesPerRegister + lane] = channel[i];
+        }
+    }
+
+    static void deinterleave(float* tile, juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t groupChannels, size_t start, size_t tileLength) noexcept
+    {
+        for(size_t lane = 0; lane < groupChannels; ++lane)
+        {
+            auto* channel = block.getChannelPointer(firstChannel + lane) + start;
+            for(size_t i = 0; i < tileLength; ++i)
+                channel[i] = tile[i * lanesPerRegister + lane];
+        }
+    }
+
+    static void encodeMidSide(float* tile, juce::dsp::AudioBlock<float>& block, size_t start, size_t tileLength) noexcept
+    {
+        auto* left = block.getChannelPointer(0) + start;
+        auto* right = block.getChannelPointer(1) + start;
+        for(size_t i = 0; i < tileLength; ++i)
+        {
+            tile[i * lanesPerRegister] = (left[i] + right[i]) * 0.5f;
+            tile[i * lanesPerRegister + 1] = (left[i] - right[i]) * 0.5f;
+        }
+    }
+
+    static void decodeMidSide(float* tile, juce::dsp::AudioBlock<float>& block, size_t start, size_t tileLength) noexcept
+    {
+        auto* left = block.getChannelPointer(0) + start;
+        auto* right = block.getChannelPointer(1) + start;
+        for(size_t i = 0; i < tileLength; ++i)
+        {
+            const auto mid = tile[i * lanesPerRegister];
+            const auto side = tile[i * lanesPerRegister + 1];
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    // One tile per group so groups can run in parallel. Unused lanes of a part filled group
+    // just filter whatever was left in the tile.
+    struct Tile
+    {
+        alignas(sizeof(SIMDFloat)) float samples[tileSize * lanesPerRegister] {};
+    };
+    std::array<Tile, maxGroups> tiles;
+};
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Lfo.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+enum LfoShape
+{
+    Sine,
+    Triangle,
+    SawUp,
+    SawDown,
+    Square
+};
+
+// Cycle lengths in quarter notes, same order as the "LfoRate" choices
+static constexpr std::array<double, 7> lfoRateBeats { 16.0, 8.0, 4.0, 2.0, 1.0, 0.5, 0.25 };
+
+inline juce::StringArray getLfoRateNames()
+{
+    return { "4/1", "2/1", "1/1", "1/2", "1/4", "1/8", "1/16" };
+}
+
+inline juce::StringArray getLfoShapeNames()
+{
+    return { "Sine", "Triangle", "Saw Up", "Saw Down", "Square" };
+}
+
+/*
+ Tempo synced LFO for the squeeze window. It is evaluated once per sub-block, so it only
+ needs to know how far to advance, and locks its phase to the host's ppq position while
+ the transport is running. When stopped it keeps free running at the last known tempo.
+ */
+struct SqueezeLfo
+{
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        phase = 0.0;
+    }
+
+    void setParameters(int rateIndex, LfoShape newShape)
+    {
+        beatsPerCycle = lfoRateBeats[(size_t) juce::jlimit(0, (int) lfoRateBeats.size() - 1, rateIndex)];
+        shape = newShape;
+    }
+
+    void syncToPlayHead(juce::AudioPlayHead* playHead)
+    {
+        if(playHead == nullptr)
+            return;
+
+        if(auto position = playHead->getPosition())
+        {
+            if(auto hostBpm = position->getBpm())
+                bpm = *hostBpm;
+
+            if(position->getIsPlaying())
+            {
+                if(auto ppq = position->getPpqPosition())
+                {
+                    auto cycles = *ppq / beatsPerCycle;
+                    phase = cycles - std::floor(cycles);
+                }
+            }
+        }
+    }
+
+    // Returns the value (-1 to 1) at the current phase, then moves on by numSamples
+    float getNextValue(int numSamples)
+    {
+        auto value = getValueAt(phase);
+
+        phase += numSamples * (bpm / 60.0) / (sampleRate * beatsPerCycle);
+        phase -= std::floor(phase);
+
+        return value;
+    }
+
+private:
+    double sampleRate = 44100.0;
+    double bpm = 120.0;
+    double beatsPerCycle = 4.0;
+    double phase = 0.0;
+    LfoShape shape = LfoShape::Sine;
+
+    float getValueAt(double p) const
+    {
+        switch(shape)
+        {
+            case Sine:     return (float) std::sin(p * juce::MathConstants<double>::twoPi);
+            case Triangle: return (float) (1.0 - 4.0 * std::abs(p - 0.5));
+            case SawUp:    return (float) (2.0 * p - 1.0);
+            case SawDown:  return (float) (1.0 - 2.0 * p);
+            case Square:   return p < 0.5 ? 1.0f : -1.0f;
+        }
+        return 0.0f;
+    }
+};
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    Loudness.cpp
+
+  ==============================================================================
+*/
+
+#include "Loudness.h"
+
+void KWeighting::prepare(double sampleRate)
+{
+    const auto pi = juce::MathConstants<double>::pi;
+
+    // Head related shelf, +4 dB above about 1.7 kHz
+    {
+        const auto f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+        const auto k = std::tan(pi * f0 / sampleRate);
+        const auto vh = std::pow(10.0, gainDb / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        b0 = (vh + vb * k / q + k * k) / a0;
+        b1 = 2.0 * (k * k - vh) / a0;
+        b2 = (vh - vb * k / q + k * k) / a0;
+        a1 = 2.0 * (k * k - 1.0) / a0;
+        a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // Revised low frequency B curve, a second order high pass at 38 Hz
+    {
+        const auto f0 = 38.13547087602444, q = 0.5003270373238773;
+        const auto k = std::tan(pi * f0 / sampleRate);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        hpA1 = 2.0 * (k * k - 1.0) / a0;
+        hpA2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    reset();
+}
+
+double KWeighting::process(const float* data, int numSamples) noexcept
+{
+    // Both sections transposed direct form II, states kept in registers for the whole run
+    auto x1 = s1, x2 = s2, y1 = t1, y2 = t2;
+    double sum = 0.0;
+
+    for(int i = 0; i < numSamples; ++i)
+    {
+        const auto x = static_cast<double>(data[i]);
+        const auto shelf = b0 * x + x1;
+        x1 = b1 * x - a1 * shelf + x2;
+        x2 = b2 * x - a2 * shelf;
+
+        const auto y = shelf + y1;
+        y1 = -2.0 * shelf - hpA1 * y + y2;
+        y2 = shelf - hpA2 * y;
+
+        sum += y * y;
+    }
+
+    s1 = x1; s2 = x2; t1 = y1; t2 = y2;
+    return sum;
+}
+
+//==============================================================================
+double LoudnessMeter::getChannelWeight(juce::AudioChannelSet::ChannelType type) noexcept
+{
+    // BS.1770-4 table 3: +1.5 dB for channels 60 to 120 degrees off centre below 30 degrees up
+    switch(type)
+    {
+        case juce::AudioChannelSet::LFE:
+        case juce::AudioChannelSet::LFE2:
+            return 0.0;
+        case juce::AudioChannelSet::leftSurround:
+        case juce::AudioChannelSet::rightSurround:
+        case juce::AudioChannelSet::leftSurroundSide:
+        case juce::AudioChannelSet::rightSurroundSide:
+        case juce::AudioChannelSet::wideLeft:
+        case juce::AudioChannelSet::wideRight:
+            return 1.41;
+        default:
+            return 1.0;
+    }
+}
+
+void LoudnessMeter::prepare(double sampleRate, const juce::AudioChannelSet& channels)
+{
+    const auto numChannels = juce::jmax(1, channels.size());
+    weightings.resize((size_t) numChannels);
+    for(auto& weighting : weightings)
+        weighting.prepare(sampleRate);
+
+    // A disabled or unknown bus gets weight 1 everywhere
+    channelWeights.assign((size_t) numChannels, 1.0);
+    for(int ch = 0; ch < channels.size(); ++ch)
+        channelWeights[(size_t) ch] = getChannelWeight(channels.getTypeOfChannel(ch));
+
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    stepPosition = 0;
+    stepEnergy = 0.0;
+
+    steps.fill(0.0);
+    stepIndex = numSteps = 0;
+    momentarySum = shortTermSum = 0.0;
+    clearIntegrated();
+
+    momentary.store(silenceLufs);
+    shortTerm.store(silenceLufs);
+    resetRequested.store(false);
+}
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(weightings.size()));
+
+    while(numSamples > 0)
+    {
+        const auto numToStep = juce::jmin(numSamples, stepLength - stepPosition);
+        for(int ch = 0; ch < numChannels; ++ch)
+            if(channelWeights[(size_t) ch] > 0.0)
+                stepEnergy += channelWeights[(size_t) ch] * weightings[(size_t) ch].process(buffer.getReadPointer(ch, startSample), numToStep);
+
+        startSample += numToStep;
+        numSamples -= numToStep;
+        stepPosition += numToStep;
+        if(stepPosition == stepLength)
+            endStep();
+    }
+}
+
+void LoudnessMeter::processSilence(int numSamples) noexcept
+{
+    for(auto& weighting : weightings)
+        weighting.reset();
+
+    while(numSamples > 0)
+    {
+        const auto numToStep = juce::jmin(numSamples, stepLength - stepPosition);
+        numSamples -= numToStep;
+        stepPosition += numToStep;
+        if(stepPosition == stepLength)
+            endStep();
+    }
+}
+
+void LoudnessMeter::endStep() noexcept
+{
+    if(resetRequested.exchange(false))
+        clearIntegrated();
+
+    // The step leaving each window comes off its running sum, the new one goes on
+    const auto leavingMomentary = steps[(size_t) ((stepIndex + stepsPerShortTerm - stepsPerMomentary) % stepsPerShortTerm)];
+    momentarySum = juce::jmax(0.0, momentarySum + stepEnergy - (numSteps >= stepsPerMomentary ? leavingMomentary : 0.0));
+    shortTermSum = juce::jmax(0.0, shortTermSum + stepEnergy - (numSteps >= stepsPerShortTerm ? steps[(size_t) stepIndex] : 0.0));
+    steps[(size_t) stepIndex] = stepEnergy;
+    stepIndex = (stepIndex + 1) % stepsPerShortTerm;
+    numSteps = juce::jmin(numSteps + 1, stepsPerShortTerm);
+
+    stepEnergy = 0.0;
+    stepPosition = 0;
+
+    if(numSteps < stepsPerMomentary)
+        return;
+
+    // Every momentary window is a gating block
+    const auto blockEnergy = momentarySum / (stepsPerMomentary * static_cast<double>(stepLength));
+    const auto blockLufs = toLufs(blockEnergy);
+    momentary.store(blockLufs, std::memory_order_relaxed);
+
+    if(numSteps == stepsPerShortTerm)
+        shortTerm.store(toLufs(shortTermSum / (stepsPerShortTerm * static_cast<double>(stepLength))), std::memory_order_relaxed);
+
+    if(blockLufs > minGatedLufs)
+    {
+        const auto bin = juce::jlimit(0, numBins - 1, static_cast<int>((blockLufs - minGatedLufs) / binWidth));
+        binEnergies[(size_t) bin] += blockEnergy;
+        ++binCounts[(size_t) bin];
+        gatedEnergy += blockEnergy;
+        ++numGated;
+        integrated.store(getIntegrated(), std::memory_order_relaxed);
+    }
+}
+
+void LoudnessMeter::clearIntegrated() noexcept
+{
+    binEnergies.fill(0.0);
+    binCounts.fill(0);
+    numGated = 0;
+    gatedEnergy = 0.0;
+    integrated.store(silenceLufs, std::memory_order_relaxed);
+}
+
+float LoudnessMeter::getIntegrated() const noexcept
+{
+    if(numGated == 0)
+        return silenceLufs;
+
+    // Relative gate 10 LU under the loudness of everything above the absolute gate. Whole bins
+    // are kept or dropped, which puts the gate within 0.1 LU.
+    const auto relativeGate = toLufs(gatedEnergy / static_cast<double>(numGated)) - 10.0f;
+    const auto firstBin = juce::jlimit(0, numBins, static_cast<int>(std::ceil((relativeGate - minGatedLufs) / binWidth)));
+
+    double energy = 0.0;
+    juce::uint64 count = 0;
+    for(int b = firstBin; b < numBins; ++b)
+    {
+        energy += binEnergies[(size_t) b];
+        count += binCounts[(size_t) b];
+    }
+    return count > 0 ? toLufs(energy / static_cast<double>(count)) : silenceLufs;
+}
+
+float LoudnessMeter::toLufs(double meanSquare) noexcept
+{
+    return meanSquare > 0.0 ? static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)) : silenceLufs;
+}
+
+LoudnessReading LoudnessMeter::read() const
+{
+    return { momentary.load(std::memory_order_relaxed),
+             shortTerm.load(std::memory_order_relaxed),
+             integrated.load(std::memory_order_relaxed) };
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    Loudness.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+struct LoudnessReading
+{
+    // LUFS, silenceLufs until there is enough signal to measure
+    float momentary, shortTerm, integrated;
+};
+
+/*
+ The BS.1770 K-weighting: the head related shelf and the RLB high pass, run back to back in one
+ loop with the mean square summed as it goes, so the weighted signal never has to be stored.
+ Designed for any sample rate from the analogue prototypes, matching the published 48 kHz
+ coefficients. Double precision, the high pass pole sits very close to 1.
+ */
+struct KWeighting
+{
+    void prepare(double sampleRate);
+    void reset() { s1 = s2 = t1 = t2 = 0.0; }
+    // Sum of the squared weighted samples
+    double process(const float* data, int numSamples) noexcept;
+
+private:
+    double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;    // shelf
+    double hpA1 = 0, hpA2 = 0;                         // high pass, the numerator is 1, -2, 1
+    double s1 = 0, s2 = 0, t1 = 0, t2 = 0;
+};
+
+/*
+ Momentary (400 ms), short-term (3 s) and integrated loudness, ITU-R BS.1770-4 / EBU R128.
+
+ Weighted energy is summed in 100 ms steps. The last 30 steps sit in a ring with running sums
+ for the 4 and 30 step windows, so the windows cost O(1) a step. Each 400 ms gating block (75%
+ overlap) lands in a histogram of 0.1 LU bins that keeps its count and exact energy, which is
+ all the two gates need: integrated loudness runs in constant memory however long the session
+ is, re-gated from the 800 bins once a step.
+
+ Channels are weighted as BS.1770 has them for the bus layout: 1.41 for the surrounds at the
+ sides, none for the LFE, 1 for everything else. The audio thread measures and publishes
+ through atomics.
+ */
+class LoudnessMeter
+{
+public:
+    static constexpr float silenceLufs = -100.0f;
+
+    // Not while the audio thread is running
+    void prepare(double sampleRate, const juce::AudioChannelSet& channels);
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+    // Time passing with the input below -120 dB, without running the filters
+    void processSilence(int numSamples) noexcept;
+
+    // Any thread
+    LoudnessReading read() const;
+    // Any thread, the audio thread starts over at its next step
+    void resetIntegrated() { resetRequested.store(true); }
+
+private:
+    static constexpr int stepsPerMomentary = 4, stepsPerShortTerm = 30;
+    static constexpr float minGatedLufs = -70.0f, maxGatedLufs = 10.0f, binWidth = 0.1f;
+    static constexpr int numBins = static_cast<int>((maxGatedLufs - minGatedLufs) / binWidth);
+
+    std::vector<KWeighting> weightings;
+    std::vector<double> channelWeights;
+    static double getChannelWeight(juce::AudioChannelSet::ChannelType type) noexcept;
+    int stepLength = 0, stepPosition = 0;
+    double stepEnergy = 0.0;
+
+    std::array<double, stepsPerShortTerm> steps {};
+    int stepIndex = 0, numSteps = 0;
+    double momentarySum = 0.0, shortTermSum = 0.0;
+
+    std::array<double, numBins> binEnergies {};
+    std::array<juce::uint64, numBins> binCounts {};
+    juce::uint64 numGated = 0;
+    double gatedEnergy = 0.0;
+
+    std::atomic<float> momentary {silenceLufs}, shortTerm {silenceLufs}, integrated {silenceLufs};
+    std::atomic<bool> resetRequested {false};
+
+    void endStep() noexcept;
+    void clearIntegrated() noexcept;
+    float getIntegrated() const noexcept;
+    static float toLufs(double meanSquare) noexcept;
+};
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    Metering.cpp
+
+  ==============================================================================
+*/
+
+#include "Metering.h"
+
+// ITU-R BS.1770-4 Annex 2, phase by phase; phases 2 and 3 are 1 and 0 reversed
+static constexpr float interpolatorPhases[2][TruePeakDetector::numTaps] =
+{
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f }
+};
+
+static constexpr float silenceDb = -100.0f;
+
+TruePeakDetector::TruePeakDetector()
+{
+    for(int t = 0; t < numTaps; ++t)
+    {
+        taps[(size_t) t].set(0, interpolatorPhases[0][t]);
+        taps[(size_t) t].set(1, interpolatorPhases[1][t]);
+        taps[(size_t) t].set(2, interpolatorPhases[1][numTaps - 1 - t]);
+        taps[(size_t) t].set(3, interpolatorPhases[0][numTaps - 1 - t]);
+    }
+}
+
+void TruePeakDetector::reset()
+{
+    history.fill(0.0f);
+    position = 0;
+}
+
+float TruePeakDetector::process(const float* data, int numSamples) noexcept
+{
+    auto peak = SIMDFloat::expand(0.0f);
+
+    for(int i = 0; i < numSamples; ++i)
+    {
+        history[(size_t) position] = history[(size_t) (position + numTaps)] = data[i];
+
+        // history[position + numTaps - t] is the sample t steps back
+        const auto* newest = history.data() + position + numTaps;
+        auto y = taps[0] * newest[0];
+        for(int t = 1; t < numTaps; ++t)
+            y += taps[(size_t) t] * newest[-t];
+
+        peak = SIMDFloat::max(peak, SIMDFloat::max(y, SIMDFloat::expand(0.0f) - y));
+        position = position + 1 == numTaps ? 0 : position + 1;
+    }
+
+    return juce::jmax(peak.get(0), peak.get(1), peak.get(2), peak.get(3));
+}
+
+//==============================================================================
+void LevelMeter::prepare(double sampleRate)
+{
+    for(auto* level : { &rmsLevelLeft, &rmsLevelRight })
+    {
+        level->reset(sampleRate, rmsSeconds);
+        level->setCurrentAndTargetValue(silenceDb);
+    }
+    for(auto& detector : truePeakDetectors)
+        detector.reset();
+
+    for(size_t ch = 0; ch < 2; ++ch)
+    {
+        rms[ch].store(silenceDb);
+        peaks[ch].store(0.0f);
+        truePeaks[ch].store(0.0f);
+    }
+}
+
+float LevelMeter::getSumOfSquares(const float* data, int numSamples) noexcept
+{
+    float sum = 0.0f;
+    int i = 0;
+    for(; i < numSamples && ! SIMDFloat::isSIMDAligned(data + i); ++i)
+        sum += data[i] * data[i];
+
+    auto squares = SIMDFloat::expand(0.0f);
+    for(; i + (int) SIMDFloat::SIMDNumElements <= numSamples; i += (int) SIMDFloat::SIMDNumElements)
+    {
+        const auto x = SIMDFloat::fromRawArray(data + i);
+        squares += x * x;
+    }
+
+    for(; i < numSamples; ++i)
+        sum += data[i] * data[i];
+    return sum + squares.sum();
+}
+
+void LevelMeter::raiseTo(std::atomic<float>& value, float level) noexcept
+{
+    // Races with read() resetting it, so it cannot simply store the larger one
+    auto current = value.load(std::memory_order_relaxed);
+    while(level > current && ! value.compare_exchange_weak(current, level, std::memory_order_relaxed))
+        ;
+}
+
+void LevelMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    if(numSamples <= 0)
+        return;
+
+    const auto numChannels = buffer.getNumChannels();
+    for(int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* data = buffer.getReadPointer(ch, startSample);
+        const auto shown = (size_t) juce::jmin(ch, 1);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+        raiseTo(peaks[shown], juce::jmax(-range.getStart(), range.getEnd()));
+
+        // Only the shown channels are worth the oversampling
+        if(ch < 2)
+            raiseTo(truePeaks[shown], truePeakDetectors[shown].process(data, numSamples));
+
+        if(ch < 2)
+        {
+            auto& level = ch == 0 ? rmsLevelLeft : rmsLevelRight;
+            const auto meanSquare = getSumOfSquares(data, numSamples) / static_cast<float>(numSamples);
+            level.setTargetValue(juce::Decibels::gainToDecibels(std::sqrt(meanSquare), silenceDb));
+            level.skip(numSamples);
+            rms[shown].store(level.getCurrentValue(), std::memory_order_relaxed);
+        }
+    }
+
+    // Mono shows the one channel on both sides
+    if(numChannels == 1)
+    {
+        rms[1].store(rms[0].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        raiseTo(peaks[1], peaks[0].load(std::memory_order_relaxed));
+        raiseTo(truePeaks[1], truePeaks[0].load(std::memory_order_relaxed));
+    }
+}
+
+std::array<MeterLevels, 2> LevelMeter::read()
+{
+    std::array<MeterLevels, 2> levels;
+    for(size_t ch = 0; ch < 2; ++ch)
+    {
+        levels[ch].rms = rms[ch].load(std::memory_order_relaxed);
+        levels[ch].peak = juce::Decibels::gainToDecibels(peaks[ch].exchange(0.0f, std::memory_order_relaxed), silenceDb);
+        // Never below the sample peak, the interpolator ripples a little under it
+        levels[ch].truePeak = juce::jmax(levels[ch].peak,
+                                         juce::Decibels::gainToDecibels(truePeaks[ch].exchange(0.0f, std::memory_order_relaxed), silenceDb));
+    }
+    return levels;
+}
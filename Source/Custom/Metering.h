@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Metering.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "LaneFilter.h"
+
+// What a meter shows for one channel, all in dB
+struct MeterLevels
+{
+    float rms = -100.0f, peak = -100.0f, truePeak = -100.0f;
+};
+
+/*
+ Interpolated peaks between samples, as BS.1770 Annex 2 measures them: 4x oversampling with its
+ 48 tap interpolator split into 4 phases of 12 taps. Each SIMD register holds one tap of all 4
+ phases, so every input sample costs 12 multiply-adds for all the in-between points at once.
+ */
+class TruePeakDetector
+{
+public:
+    static constexpr int numTaps = 12;
+    static_assert(SIMDFloat::SIMDNumElements == 4, "one lane per phase");
+
+    TruePeakDetector();
+    void reset();
+    // Largest absolute value of the oversampled signal over this run of samples
+    float process(const float* data, int numSamples) noexcept;
+
+private:
+    std::array<SIMDFloat, numTaps> taps;   // taps[t] multiplies the sample t steps back
+    // Every sample is written twice, numTaps apart, so the last numTaps are always contiguous
+    std::array<float, 2 * numTaps> history {};
+    int position = 0;
+};
+
+/*
+ Input or output levels, measured on the audio thread a tile at a time while the samples are
+ in cache. RMS and peak are vectorised block reductions; the RMS is smoothed in dB over
+ rmsSeconds, the peaks are held until the editor reads them. Everything is published through
+ atomics, a reader never waits and nothing goes through a fifo.
+
+ Up to two channels are shown; wider buses fold the rest in by the maximum.
+ */
+class LevelMeter
+{
+public:
+    static constexpr double rmsSeconds = 0.3;
+
+    // Not while the audio thread is running
+    void prepare(double sampleRate);
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    // Any thread. Reading hands back the peaks since the last read and starts new ones, so
+    // only one reader (the editor) should ask.
+    std::array<MeterLevels, 2> read();
+
+private:
+    // RMS ballistics, in dB
+    juce::LinearSmoothedValue<float> rmsLevelLeft, rmsLevelRight;
+    std::array<TruePeakDetector, 2> truePeakDetectors;
+
+    std::array<std::atomic<float>, 2> rms { -100.0f, -100.0f };
+    std::array<std::atomic<float>, 2> peaks { 0.0f, 0.0f }, truePeaks { 0.0f, 0.0f };
+
+    static float getSumOfSquares(const float* data, int numSamples) noexcept;
+    static void raiseTo(std::atomic<float>& value, float level) noexcept;
+};
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    Meters.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "colors.h"
+
+// DSP load and the counters behind it, polled from the processor a few times a second
+struct LoadMeter : juce::Component, juce::Timer
+{
+    LoadMeter(SqueezeFilterAudioProcessor& p) : audioProcessor(p)
+    {
+        setInterceptsMouseClicks(false, false);
+       #if SQUEEZE_TELEMETRY
+        startTimerHz(4);
+       #endif
+    }
+
+    void timerCallback() override
+    {
+        snapshot = audioProcessor.getTelemetry();
+        analyzerBytes = audioProcessor.getAnalyzerMemoryBytes();
+        repaint();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+       #if SQUEEZE_TELEMETRY
+        auto bounds = getLocalBounds().reduced(4);
+        const auto lineHeight = bounds.getHeight() / 2;
+        g.setFont(juce::jmin(12.0f, lineHeight * 0.9f));
+
+        // Lime below half the deadline, orange as it gets close
+        g.setColour(snapshot.p99Load < 0.5 ? myColourLime : juce::Colours::orange);
+        auto percent = [](double load) { return juce::String(load * 100.0, 1) + "%"; };
+        g.drawFittedText("DSP " + percent(snapshot.smoothedLoad) + "  p99 " + percent(snapshot.p99Load)
+                         + "  max " + percent(snapshot.maxLoad),
+                         bounds.removeFromTop(lineHeight), juce::Justification::centredRight, 1);
+
+        g.setColour(juce::Colours::darkgrey);
+        g.drawFittedText(juce::String(snapshot.numOverruns) + " overruns  "
+                         + juce::String(snapshot.numAnalyzerOverflows) + " dropped  "
+                         + "analyzer " + juce::String(static_cast<int>(analyzerBytes / 1024)) + " KB",
+                         bounds, juce::Justification::centredRight, 1);
+       #else
+        juce::ignoreUnused(g);
+       #endif
+    }
+
+private:
+    SqueezeFilterAudioProcessor& audioProcessor;
+    TelemetrySnapshot snapshot;
+    size_t analyzerBytes = 0;
+};
+
+/*
+ Input and output bars, left and right, read from the processor's atomics at the editor's
+ frame rate. The bar is the RMS, the line above it the peak held for a second, and the mark
+ at the top turns red once the true peak has gone over 0 dBTP.
+ */
+struct LevelMeters : juce::Component, juce::Timer
+{
+    static constexpr float minDb = -60.0f, maxDb = 6.0f;
+
+    LevelMeters(SqueezeFilterAudioProcessor& p) : audioProcessor(p)
+    {
+        startTimerHz(30);
+    }
+
+    void timerCallback() override
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        auto update = [now](Bar& bar, const MeterLevels& levels)
+        {
+            bar.rms = levels.rms;
+            if(levels.peak >= bar.heldPeak || now - bar.heldSince > 1000)
+            {
+                bar.heldPeak = levels.peak;
+                bar.heldSince = now;
+            }
+            bar.clipped = bar.clipped || levels.truePeak > 0.0f;
+        };
+
+        const auto input = audioProcessor.readInputLevels();
+        const auto output = audioProcessor.readOutputLevels();
+        for(size_t ch = 0; ch < 2; ++ch)
+        {
+            update(bars[ch], input[ch]);
+            update(bars[ch + 2], output[ch]);
+        }
+        repaint();
+    }
+
+    // A click clears the over marks
+    void mouseDown(const juce::MouseEvent&) override
+    {
+        for(auto& bar : bars)
+            bar.clipped = false;
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().toFloat().reduced(2.0f);
+        const auto barWidth = bounds.getWidth() / 5.0f;
+        auto toY = [&](float db) { return juce::jmap(juce::jlimit(minDb, maxDb, db), minDb, maxDb, bounds.getBottom(), bounds.getY()); };
+
+        for(size_t b = 0; b < bars.size(); ++b)
+        {
+            // A gap between input and output
+            const auto x = bounds.getX() + barWidth * static_cast<float>(b < 2 ? b : b + 1);
+            auto& bar = bars[b];
+
+            g.setColour(juce::Colours::black.withAlpha(0.3f));
+            g.fillRect(x, bounds.getY(), barWidth - 1.0f, bounds.getHeight());
+
+            g.setColour(myColourLime.withAlpha(0.8f));
+            const auto top = toY(bar.rms);
+            g.fillRect(x, top, barWidth - 1.0f, bounds.getBottom() - top);
+
+            g.setColour(myColourLime);
+            g.fillRect(x, toY(bar.heldPeak), barWidth - 1.0f, 1.5f);
+
+            g.setColour(bar.clipped ? juce::Colours::red : juce::Colours::darkgrey);
+            g.fillRect(x, bounds.getY(), barWidth - 1.0f, 3.0f);
+        }
+
+        g.setColour(juce::Colours::darkgrey);
+        g.drawHorizontalLine(juce::roundToInt(toY(0.0f)), bounds.getX(), bounds.getRight());
+    }
+
+private:
+    struct Bar
+    {
+        float rms = -100.0f, heldPeak = -100.0f;
+        juce::uint32 heldSince = 0;
+        bool clipped = false;
+    };
+
+    SqueezeFilterAudioProcessor& audioProcessor;
+    std::array<Bar, 4> bars;   // input left, right, output left, right
+};
+
+// Momentary, short-term and integrated LUFS before and after the filters. A click restarts
+// the integrated measurement.
+struct LoudnessDisplay : juce::Component, juce::Timer
+{
+    LoudnessDisplay(SqueezeFilterAudioProcessor& p) : audioProcessor(p)
+    {
+        startTimerHz(10);
+    }
+
+    void timerCallback() override
+    {
+        input = audioProcessor.getInputLoudness();
+        output = audioProcessor.getOutputLoudness();
+        repaint();
+    }
+
+    void mouseDown(const juce::MouseEvent&) override
+    {
+        audioProcessor.resetIntegratedLoudness();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().reduced(4);
+        const auto lineHeight = bounds.getHeight() / 3;
+        g.setFont(juce::jmin(12.0f, lineHeight * 0.9f));
+
+        auto lufs = [](float value) { return value <= LoudnessMeter::silenceLufs ? juce::String("-inf") : juce::String(value, 1); };
+        auto line = [&](const juce::String& name, float in, float out)
+        {
+            g.drawFittedText(name + "  " + lufs(in) + " > " + lufs(out) + " LUFS",
+                             bounds.removeFromTop(lineHeight), juce::Justification::centredRight, 1);
+        };
+
+        g.setColour(myColourLime);
+        line("M", input.momentary, output.momentary);
+        line("S", input.shortTerm, output.shortTerm);
+        g.setColour(juce::Colours::darkgrey);
+        line("I", input.integrated, output.integrated);
+    }
+
+private:
+    SqueezeFilterAudioProcessor& audioProcessor;
+    LoudnessReading input {}, output {};
+};
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    Morph.cpp
+
+  ==============================================================================
+*/
+
+#include "Morph.h"
+
+static int designCut(CutSections& sections, bool isHighPass, float frequency, Slope slope, const DesignSpec& spec)
+{
+    if(spec.type == ResponseType::Butterworth)
+        return designCutSections(sections, isHighPass, frequency, spec.sampleRate, slope);
+
+    auto slopeSpec = spec;
+    slopeSpec.lowCutSlope = slopeSpec.highCutSlope = slope;
+    return designSpecCutSections(sections, isHighPass, frequency, slopeSpec);
+}
+
+static float interpolateLog(float from, float to, float t)
+{
+    return std::exp(std::log(from) + t * (std::log(to) - std::log(from)));
+}
+
+static BiquadCoefficients blend(const BiquadCoefficients& a, const BiquadCoefficients& b, float t)
+{
+    BiquadCoefficients c;
+    c.b0 = a.b0 + t * (b.b0 - a.b0);
+    c.b1 = a.b1 + t * (b.b1 - a.b1);
+    c.b2 = a.b2 + t * (b.b2 - a.b2);
+    c.a1 = a.a1 + t * (b.a1 - a.a1);
+    c.a2 = a.a2 + t * (b.a2 - a.a2);
+    return c;
+}
+
+// Fills sections past 'count' with pass-through ones, up to 'total'
+static void pad(CutSections& sections, int count, int total)
+{
+    for(int k = count; k < total; ++k)
+        sections[(size_t) k] = BiquadCoefficients();
+}
+
+void MorphGrid::build(const std::vector<ChainSettings>& snapshotsToUse, const DesignSpec& specToUse)
+{
+    spec = specToUse;
+    numSnapshots = juce::jmin(static_cast<int>(snapshotsToUse.size()), maxSnapshots);
+    std::copy_n(snapshotsToUse.begin(), numSnapshots, snapshots.begin());
+    numPoints = numSnapshots > 1 ? (numSnapshots - 1) * pointsPerSegment + 1 : 0;
+
+    if(numPoints == 0 || spec.sampleRate <= 0.0)
+    {
+        numPoints = 0;
+        return;
+    }
+
+    // Every position runs as many sections as the deepest snapshot needs
+    numLowCut = numHighCut = 0;
+    steepestLowCut = steepestHighCut = Slope_12;
+    CutSections scratch;
+    for(int s = 0; s < numSnapshots; ++s)
+    {
+        auto& snapshot = snapshots[(size_t) s];
+        numLowCut = juce::jmax(numLowCut, designCut(scratch, true, snapshot.lowCutFreq, snapshot.lowCutSlope, spec));
+        numHighCut = juce::jmax(numHighCut, designCut(scratch, false, snapshot.highCutFreq, snapshot.highCutSlope, spec));
+        steepestLowCut = juce::jmax(steepestLowCut, snapshot.lowCutSlope);
+        steepestHighCut = juce::jmax(steepestHighCut, snapshot.highCutSlope);
+    }
+
+    for(int p = 0; p < numPoints; ++p)
+    {
+        const auto segment = juce::jmin(p / pointsPerSegment, numSnapshots - 2);
+        const auto t = static_cast<float>(p - segment * pointsPerSegment) / static_cast<float>(pointsPerSegment);
+        auto& from = snapshots[(size_t) segment];
+        auto& to = snapshots[(size_t) segment + 1];
+
+        auto designPoint = [&](CutSections& point, int total, bool isHighPass)
+        {
+            const auto frequency = isHighPass ? interpolateLog(from.lowCutFreq, to.lowCutFreq, t)
+                                              : interpolateLog(from.highCutFreq, to.highCutFreq, t);
+            CutSections a, b;
+            pad(a, designCut(a, isHighPass, frequency, isHighPass ? from.lowCutSlope : from.highCutSlope, spec), total);
+            pad(b, designCut(b, isHighPass, frequency, isHighPass ? to.lowCutSlope : to.highCutSlope, spec), total);
+            for(int k = 0; k < total; ++k)
+                point[(size_t) k] = blend(a[(size_t) k], b[(size_t) k], t);
+        };
+        designPoint(lowCutPoints[(size_t) p], numLowCut, true);
+        designPoint(highCutPoints[(size_t) p], numHighCut, false);
+    }
+}
+
+bool MorphGrid::matches(const DesignSpec& other) const
+{
+    return numPoints > 0 && spec.type == other.type && spec.sampleRate == other.sampleRate
+        && (spec.type == ResponseType::Butterworth
+            || (spec.targetAttenuation == other.targetAttenuation && spec.targetDistance == other.targetDistance));
+}
+
+ChainSettings MorphGrid::getSettings(float position) const noexcept
+{
+    ChainSettings settings;
+    if(numSnapshots < 2)
+        return numSnapshots == 1 ? snapshots[0] : settings;
+
+    const auto x = juce::jlimit(0.0f, 1.0f, position) * static_cast<float>(numSnapshots - 1);
+    const auto segment = juce::jmin(static_cast<int>(x), numSnapshots - 2);
+    const auto t = x - static_cast<float>(segment);
+    auto& from = snapshots[(size_t) segment];
+    auto& to = snapshots[(size_t) segment + 1];
+
+    settings.lowCutFreq = interpolateLog(from.lowCutFreq, to.lowCutFreq, t);
+    settings.highCutFreq = interpolateLog(from.highCutFreq, to.highCutFreq, t);
+    settings.lowCutSlope = steepestLowCut;
+    settings.highCutSlope = steepestHighCut;
+    return settings;
+}
+
+void MorphGrid::lookup(float position, CutSections& lowCut, int& numLow, CutSections& highCut, int& numHigh) const noexcept
+{
+    jassert(numPoints > 1);
+    const auto x = juce::jlimit(0.0f, 1.0f, position) * static_cast<float>(numPoints - 1);
+    const auto index = juce::jmin(static_cast<int>(x), numPoints - 2);
+    const auto t = x - static_cast<float>(index);
+
+    for(int k = 0; k < numLowCut; ++k)
+        lowCut[(size_t) k] = blend(lowCutPoints[(size_t) index][(size_t) k], lowCutPoints[(size_t) index + 1][(size_t) k], t);
+    for(int k = 0; k < numHighCut; ++k)
+        highCut[(size_t) k] = blend(highCutPoints[(size_t) index][(size_t) k], highCutPoints[(size_t) index + 1][(size_t) k], t);
+
+    numLow = numLowCut;
+    numHigh = numHighCut;
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    Morph.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+#include "CutDesign.h"
+
+/*
+ Sections for every morph position between stored snapshots, designed ahead on the message
+ thread. Snapshots are ChainSettings as getChainSettings made them, so they hold the cutoffs
+ that were heard. Between two snapshots the cutoffs move in the log domain and the slopes
+ crossfade: both slopes are designed at the in-between cutoff and their sections blended, the
+ shorter cascade padded with pass-through sections.
+
+ The stable region of a biquad's (a1, a2) is a triangle, which is convex, so any blend of
+ stable sections is stable too. That makes both the slope crossfade and the lookup, which
+ blends the two nearest grid points, safe at any position.
+ */
+class MorphGrid
+{
+public:
+    static constexpr int maxSnapshots = 4;
+    static constexpr int pointsPerSegment = 32;
+    static constexpr int maxPoints = (maxSnapshots - 1) * pointsPerSegment + 1;
+
+    // Message thread, may allocate for non Butterworth designs
+    void build(const std::vector<ChainSettings>& snapshotsToUse, const DesignSpec& specToUse);
+
+    // Built for this response type and sample rate; slopes come from the snapshots
+    bool matches(const DesignSpec& other) const;
+    int getNumSnapshots() const { return numSnapshots; }
+
+    // Cutoffs at 'position' (0-1 across all snapshots), slopes those of the steepest snapshot
+    ChainSettings getSettings(float position) const noexcept;
+    // O(1), no design calls. The section counts are the same at every position.
+    void lookup(float position, CutSections& lowCut, int& numLowCut, CutSections& highCut, int& numHighCut) const noexcept;
+
+private:
+    std::array<ChainSettings, maxSnapshots> snapshots;
+    int numSnapshots = 0, numPoints = 0;
+    DesignSpec spec;
+    int numLowCut = 0, numHighCut = 0;
+    Slope steepestLowCut = Slope_12, steepestHighCut = Slope_12;
+    std::array<CutSections, maxPoints> lowCutPoints, highCutPoints;
+};
+
+/*
+ Hands the newest value from one writer thread to one reader thread. Each side owns one of
+ three slots and swaps it with the shared middle one, so neither waits for the other and
+ nothing is allocated after the first write.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    // Writer: the slot to fill before publish()
+    T& getWriteBuffer()
+    {
+        if(slots[0] == nullptr)
+            for(auto& slot : slots)
+                slot = std::make_unique<T>();
+        return *slots[(size_t) writeIndex];
+    }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader: the newest published value, nullptr before the first
+    const T* read() noexcept
+    {
+        if((middle.load(std::memory_order_relaxed) & freshBit) != 0)
+        {
+            readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+            hasRead = true;
+        }
+        return hasRead ? slots[(size_t) readIndex].get() : nullptr;
+    }
+
+private:
+    static constexpr int indexMask = 3, freshBit = 4;
+    std::array<std::unique_ptr<T>, 3> slots;
+    std::atomic<int> middle {1};
+    int writeIndex = 0, readIndex = 2;
+    bool hasRead = false;
+};
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    Multiband.cpp
+
+  ==============================================================================
+*/
+
+#include "Multiband.h"
+
+using namespace juce;
+
+// Literal IDs so looking the parameters up on the audio thread never builds a String
+static const char* const crossoverIds[] { "Crossover1", "Crossover2", "Crossover3", "Crossover4" };
+static const char* const bandSqueezeIds[] { "BandSqueeze1", "BandSqueeze2", "BandSqueeze3", "BandSqueeze4", "BandSqueeze5" };
+static const char* const bandOffsetIds[] { "BandOffset1", "BandOffset2", "BandOffset3", "BandOffset4", "BandOffset5" };
+
+const char* getCrossoverId(int index) { return crossoverIds[index]; }
+const char* getBandSqueezeId(int band) { return bandSqueezeIds[band]; }
+const char* getBandOffsetId(int band) { return bandOffsetIds[band]; }
+
+MultibandSettings getMultibandSettings(juce::AudioProcessorValueTreeState& apvts,
+                                       std::array<double, maxBands>& lastLowCuts,
+                                       std::array<double, maxBands>& lastHighCuts,
+                                       const ChainModulation& modulation)
+{
+    MultibandSettings settings;
+    settings.numBands = static_cast<int>(apvts.getRawParameterValue("BandCount")->load()) + 1;
+    
+    // Keep the crossovers in order and at least a third of an octave apart
+    float lowest = 20.0f;
+    for(int i = 0; i < maxBands - 1; ++i)
+    {
+        auto freq = apvts.getRawParameterValue(crossoverIds[i])->load();
+        lowest = jlimit(lowest, 20000.0f, freq);
+        settings.crossoverFreqs[(size_t) i] = lowest;
+        lowest = jmin(lowest * 1.26f, 20000.0f);
+    }
+    
+    const double lowCutFreq = std::clamp(apvts.getRawParameterValue("hp")->load() + modulation.lowCut, 20.0f, 20000.0f);
+    const double highCutFreq = std::clamp(apvts.getRawParameterValue("lp")->load() + modulation.highCut, 20.0f, 20000.0f);
+    const auto lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCutSlope")->load());
+    const auto highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCutSlope")->load());
+    
+    for(int band = 0; band < settings.numBands; ++band)
+    {
+        auto squeeze = apvts.getRawParameterValue(bandSqueezeIds[band])->load();
+        auto offset = apvts.getRawParameterValue(bandOffsetIds[band])->load();
+        squeeze = std::clamp(squeeze + modulation.squeeze, 0.0001f, 1.0f);
+        offset = std::clamp(offset + modulation.offset, -19980.0f, 19980.0f);
+        
+        settings.bands[(size_t) band] = makeChainSettings(lowCutFreq, highCutFreq, squeeze, offset,
+                                                          lowCutSlope, highCutSlope,
+                                                          lastLowCuts[(size_t) band], lastHighCuts[(size_t) band]);
+    }
+    return settings;
+}
+
+static BiquadCoefficients makeAllPassSection(float frequency, double sampleRate)
+{
+    // Same as IIR::Coefficients::makeAllPass with a Butterworth Q, which is what the low
+    // and high pass halves of an LR4 crossover sum to
+    const auto n = 1.0f / std::tan(MathConstants<float>::pi * frequency / static_cast<float>(sampleRate));
+    const auto nSquared = n * n;
+    const auto invQ = MathConstants<float>::sqrt2;
+    const auto c1 = 1.0f / (1.0f + invQ * n + nSquared);
+    
+    BiquadCoefficients c;
+    c.b0 = c1 * (1.0f - n * invQ + nSquared);
+    c.b1 = c1 * 2.0f * (1.0f - nSquared);
+    c.b2 = 1.0f;
+    c.a1 = c.b1;
+    c.a2 = c.b0;
+    return c;
+}
+
+void MultibandSqueeze::prepare(double newSampleRate, int numChannels, const CutLookupTables* tables)
+{
+    sampleRate = newSampleRate;
+    cutTables = tables;
+    channelCascades.resize((size_t) numChannels);
+    reset();
+}
+
+void MultibandSqueeze::reset()
+{
+    for(auto& cascade : channelCascades)
+        cascade.reset();
+}
+
+void MultibandSqueeze::setSection(size_t band, size_t section, const BiquadCoefficients& c)
+{
+    for(auto& cascade : channelCascades)
+        cascade.setSection(band, section, c);
+    
+    bandRingOut += getRingOutSamples(c);
+}
+
+void MultibandSqueeze::update(const MultibandSettings& settings)
+{
+    jassert(settings.numBands >= 2 && settings.numBands <= maxBands);
+    
+    if(settings.numBands != numBands)
+    {
+        numBands = settings.numBands;
+        reset();
+    }
+    
+    const auto numCrossovers = static_cast<size_t>(numBands - 1);
+    
+    // All bands share the slopes, so every active lane ends up with the same section count
+    size_t numSections = 0;
+    double longestRingOut = 0.0;
+    
+    for(size_t band = 0; band < (size_t) maxBands; ++band)
+    {
+        bandRingOut = 0.0;
+        
+        if(band >= (size_t) numBands)
+        {
+            setSection(band, 0, silentSection);
+            for(size_t k = 1; k < maxSections; ++k)
+                setSection(band, k, identitySection);
+            continue;
+        }
+        
+        // Crossover j is a high pass for every band above it, the low pass for the band just
+        // below it and an all pass for the bands further down, so all bands stay in phase
+        for(size_t j = 0; j < numCrossovers; ++j)
+        {
+            const auto freq = settings.crossoverFreqs[j];
+            const auto first = j * sectionsPerCrossover;
+            
+            if(j < band)
+            {
+                auto section = makeButterworthSection(true, freq, sampleRate, 2, 0);
+                setSection(band, first, section);
+                setSection(band, first + 1, section);
+            }
+            else if(j == band)
+            {
+                auto section = makeButterworthSection(false, freq, sampleRate, 2, 0);
+                setSection(band, first, section);
+                setSection(band, first + 1, section);
+            }
+            else
+            {
+                setSection(band, first, makeAllPassSection(freq, sampleRate));
+                setSection(band, first + 1, identitySection);
+            }
+        }
+        
+        // Then the band's own squeeze window, the same sections the single band path runs
+        const auto& chainSettings = settings.bands[band];
+        auto section = numCrossovers * sectionsPerCrossover;
+        
+        CutSections cutSections;
+        const auto numLowCut = designCut(cutSections, true, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+        for(int k = 0; k < numLowCut; ++k)
+            setSection(band, section++, cutSections[(size_t) k]);
+        
+        const auto numHighCut = designCut(cutSections, false, chainSettings.highCutFreq, chainSettings.highCutSlope);
+        for(int k = 0; k < numHighCut; ++k)
+            setSection(band, section++, cutSections[(size_t) k]);
+        
+        numSections = section;
+        longestRingOut = jmax(longestRingOut, bandRingOut);
+    }
+    
+    for(auto& cascade : channelCascades)
+        cascade.setNumSections(numSections);
+    
+    tailSamples = static_cast<int>(std::ceil(longestRingOut));
+}
+
+int MultibandSqueeze::designCut(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept
+{
+    if(cutTables != nullptr)
+        return cutTables->lookup(sections, isHighPass, frequency, slope);
+    return designCutSections(sections, isHighPass, frequency, sampleRate, slope);
+}
+
+void MultibandSqueeze::process(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = jmin(block.getNumChannels(), channelCascades.size());
+    const auto numSamples = block.getNumSamples();
+    
+    for(size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto& cascade = channelCascades[ch];
+        auto* data = block.getChannelPointer(ch);
+        
+        for(size_t i = 0; i < numSamples; ++i)
+            data[i] = cascade.processSampleSummed(data[i]);
+    }
+}
+
+//==============================================================================
+#if SQUEEZE_UNIT_TESTS
+
+// With every band's window wide open the LR4 split sums to an all pass, so a sine of any
+// frequency has to come out at the level it went in
+class MultibandSqueezeTests : public UnitTest
+{
+public:
+    MultibandSqueezeTests() : UnitTest("MultibandSqueeze", "SqueezeFilter") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+
+        for(int numBands = 2; numBands <= maxBands; ++numBands)
+        {
+            beginTest(String(numBands) + " bands at unity sum flat");
+
+            MultibandSqueeze multiband;
+            multiband.prepare(sampleRate, 1);
+            multiband.update(makeOpenSettings(numBands));
+
+            for(auto frequency : { 100.0f, 200.0f, 1000.0f, 2500.0f, 5000.0f })
+                expectWithinAbsoluteError(measureGainDb(multiband, frequency, sampleRate), 0.0f, 0.25f,
+                                          String(frequency) + " Hz");
+        }
+    }
+
+private:
+    static MultibandSettings makeOpenSettings(int numBands)
+    {
+        MultibandSettings settings;
+        settings.numBands = numBands;
+        settings.crossoverFreqs = { 200.0f, 800.0f, 2500.0f, 8000.0f };
+        for(auto& band : settings.bands)
+        {
+            band.lowCutFreq = 20.0f;
+            band.highCutFreq = 20000.0f;
+        }
+        return settings;
+    }
+
+    // Level of the second half, once the crossovers have settled
+    static float measureGainDb(MultibandSqueeze& multiband, float frequency, double sampleRate)
+    {
+        const auto numSamples = static_cast<int>(sampleRate);
+        AudioBuffer<float> buffer(1, numSamples);
+        for(int i = 0; i < numSamples; ++i)
+            buffer.setSample(0, i, std::sin(MathConstants<float>::twoPi * frequency * static_cast<float>(i / sampleRate)));
+
+        multiband.reset();
+        dsp::AudioBlock<float> block(buffer);
+        multiband.process(block);
+
+        const auto rms = buffer.getRMSLevel(0, numSamples / 2, numSamples / 2);
+        return Decibels::gainToDecibels(rms * MathConstants<float>::sqrt2);
+    }
+};
+
+static MultibandSqueezeTests multibandSqueezeTests;
+
+#endif
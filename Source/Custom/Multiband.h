@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Multiband.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+#include "LaneFilter.h"
+#include "CutLookup.h"
+
+static constexpr int maxBands = 5;
+
+inline juce::StringArray getBandCountNames()
+{
+    return { "Off", "2", "3", "4", "5" };
+}
+
+const char* getCrossoverId(int index);
+const char* getBandSqueezeId(int band);
+const char* getBandOffsetId(int band);
+
+struct MultibandSettings
+{
+    int numBands {1};
+    std::array<float, maxBands - 1> crossoverFreqs {};
+    std::array<ChainSettings, maxBands> bands;
+};
+
+// Every band uses the global hp/lp range and slopes with its own squeeze/offset window.
+// The modulation is added to each band's window the same way getChainSettings adds it.
+MultibandSettings getMultibandSettings(juce::AudioProcessorValueTreeState& apvts,
+                                       std::array<double, maxBands>& lastLowCuts,
+                                       std::array<double, maxBands>& lastHighCuts,
+                                       const ChainModulation& modulation = {});
+
+/*
+ Splits the signal with Linkwitz-Riley (LR4) crossovers, squeezes every band and sums them.
+ Each band is one SIMD lane running the full path for that band: the crossover stages it
+ needs (high pass below the band, low pass above it, all pass compensation for the ones
+ further up) followed by its own low and high cut. All bands advance together, so adding a
+ band mostly costs lanes that are already being computed.
+ */
+class MultibandSqueeze
+{
+public:
+    // The tables are the processor's, for this sample rate; without them every cut is designed
+    void prepare(double newSampleRate, int numChannels, const CutLookupTables* tables = nullptr);
+    void reset();
+
+    // Redesigns every lane, no allocation so it can run per modulation sub-block
+    void update(const MultibandSettings& settings);
+
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    int getNumBands() const { return numBands; }
+
+    // Ring-out of the slowest band as of the last update
+    int getTailSamples() const { return tailSamples; }
+
+private:
+    static constexpr size_t sectionsPerCrossover = 2;
+    static constexpr size_t maxSections = sectionsPerCrossover * (maxBands - 1) + 2 * maxCutSections;
+    using BandCascade = LaneCascade<maxBands, maxSections>;
+    std::vector<BandCascade> channelCascades;
+
+    double sampleRate = 44100.0;
+    const CutLookupTables* cutTables = nullptr;
+    int numBands = 1;
+    int tailSamples = 0;
+    double bandRingOut = 0.0;
+
+    void setSection(size_t band, size_t section, const BiquadCoefficients& c);
+    int designCut(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept;
+};
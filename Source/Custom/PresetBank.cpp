@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+static float readFloat(const char* p)
+{
+    const auto bits = juce::ByteOrder::littleEndianInt(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static Slope readSlope(const char* p)
+{
+    return static_cast<Slope>(juce::jlimit(0, static_cast<int>(Slope_96), static_cast<int>(static_cast<juce::uint8>(*p))));
+}
+
+bool PresetBank::open(const juce::File& file)
+{
+    close();
+
+    map = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    data = static_cast<const char*>(map->getData());
+    size = map->getSize();
+
+    if(data == nullptr || size < headerSize || juce::ByteOrder::littleEndianInt(data) != magic)
+    {
+        close();
+        return false;
+    }
+
+    const auto count = static_cast<size_t>(juce::ByteOrder::littleEndianInt(data + 8));
+    namesOffset = juce::ByteOrder::littleEndianInt(data + 12);
+    if(namesOffset < headerSize + count * entrySize || namesOffset > size)
+    {
+        close();
+        return false;
+    }
+
+    numPresets = static_cast<int>(count);
+    return true;
+}
+
+void PresetBank::close()
+{
+    map.reset();
+    data = nullptr;
+    size = 0;
+    numPresets = 0;
+    namesOffset = 0;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    if(! juce::isPositiveAndBelow(index, numPresets))
+        return {};
+
+    auto* entry = getEntry(index);
+    const auto offset = namesOffset + juce::ByteOrder::littleEndianInt(entry);
+    const auto length = static_cast<size_t>(juce::ByteOrder::littleEndianShort(entry + 4));
+
+    // A damaged bank shows an empty name rather than reading past the map
+    if(offset + length > size)
+        return {};
+    return juce::String::fromUTF8(data + offset, static_cast<int>(length));
+}
+
+ChainParameters PresetBank::getParameters(int index) const
+{
+    ChainParameters parameters;
+    if(! juce::isPositiveAndBelow(index, numPresets))
+        return parameters;
+
+    auto* entry = getEntry(index);
+    parameters.lowCutSlope = readSlope(entry + 6);
+    parameters.highCutSlope = readSlope(entry + 7);
+    parameters.lowCut = readFloat(entry + 8);
+    parameters.highCut = readFloat(entry + 12);
+    parameters.squeeze = readFloat(entry + 16);
+    parameters.offset = readFloat(entry + 20);
+    return parameters;
+}
+
+int PresetBank::indexOf(const juce::String& name) const
+{
+    for(int i = 0; i < numPresets; ++i)
+        if(getName(i) == name)
+            return i;
+    return -1;
+}
+
+std::vector<Preset> PresetBank::readAll() const
+{
+    std::vector<Preset> presets;
+    presets.reserve((size_t) numPresets);
+    for(int i = 0; i < numPresets; ++i)
+        presets.push_back({ getName(i), getParameters(i) });
+    return presets;
+}
+
+bool PresetBank::write(const juce::File& file, const std::vector<Preset>& presets)
+{
+    juce::MemoryOutputStream names;
+    juce::MemoryBlock block;
+    juce::MemoryOutputStream mos(block, false);
+
+    const auto count = static_cast<juce::uint32>(presets.size());
+    mos.writeInt(static_cast<int>(magic));
+    mos.writeShort(static_cast<short>(version));
+    mos.writeShort(0);
+    mos.writeInt(static_cast<int>(count));
+    mos.writeInt(static_cast<int>(headerSize + count * entrySize));
+
+    for(auto& preset : presets)
+    {
+        const auto nameOffset = static_cast<int>(names.getDataSize());
+        auto name = preset.name.toRawUTF8();
+        const auto length = juce::jmin(static_cast<int>(std::strlen(name)), 0xffff);
+        names.write(name, static_cast<size_t>(length));
+
+        mos.writeInt(nameOffset);
+        mos.writeShort(static_cast<short>(length));
+        mos.writeByte(static_cast<char>(preset.parameters.lowCutSlope));
+        mos.writeByte(static_cast<char>(preset.parameters.highCutSlope));
+        mos.writeFloat(preset.parameters.lowCut);
+        mos.writeFloat(preset.parameters.highCut);
+        mos.writeFloat(preset.parameters.squeeze);
+        mos.writeFloat(preset.parameters.offset);
+    }
+    mos.write(names.getData(), names.getDataSize());
+    mos.flush();
+
+    // Through a temporary file, a failed write leaves the old bank as it was
+    const juce::ScopedLock sl(getFileLock());
+    return file.getParentDirectory().createDirectory() && file.replaceWithData(block.getData(), block.getSize());
+}
+
+bool PresetBank::use(const juce::File& file, const std::function<void(const PresetBank&)>& reader)
+{
+    const juce::ScopedLock sl(getFileLock());
+    PresetBank bank;
+    if(! bank.open(file))
+        return false;
+
+    reader(bank);
+    return true;
+}
+
+bool PresetBank::save(const juce::File& file, const Preset& preset)
+{
+    // Read and rewritten under the one lock, so two instances saving at once both get in
+    const juce::ScopedLock sl(getFileLock());
+    std::vector<Preset> presets;
+    use(file, [&presets](const PresetBank& bank) { presets = bank.readAll(); });
+
+    auto existing = std::find_if(presets.begin(), presets.end(), [&preset](const auto& p) { return p.name == preset.name; });
+    if(existing != presets.end())
+        *existing = preset;
+    else
+        presets.push_back(preset);
+
+    return write(file, presets);
+}
+
+juce::CriticalSection& PresetBank::getFileLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("SqueezeFilter").getChildFile("Presets.sqzbank");
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Filter.h"
+#include "CutDesign.h"
+
+struct Preset
+{
+    juce::String name;
+    ChainParameters parameters;
+};
+
+/*
+ A bank of squeeze/offset/slope presets in one file, read through a memory map. Little endian:
+
+   header   uint32 magic "SQZB", uint16 version, uint16 unused, uint32 preset count,
+            uint32 offset of the name table
+   index    per preset, 24 bytes: uint32 name offset into the table, uint16 name length,
+            uint8 low cut slope, uint8 high cut slope, then hp, lp, squeeze, offset as floats
+   names    UTF-8, not terminated
+
+ The index holds the whole preset, so browsing touches nothing but the mapped pages of the
+ entries on screen, however big the bank is. Banks are rewritten whole when they change.
+
+ Nothing keeps a bank mapped between uses: any number of instances share the file, and some
+ platforms cannot replace a file something has mapped. use() and save() hold one lock, so
+ within a process a save never replaces the file while it is being read.
+ */
+class PresetBank
+{
+public:
+    bool open(const juce::File& file);
+    void close();
+    bool isOpen() const { return map != nullptr; }
+
+    int getNumPresets() const { return numPresets; }
+    juce::String getName(int index) const;
+    ChainParameters getParameters(int index) const;
+    // First preset with this name, -1 if there is none
+    int indexOf(const juce::String& name) const;
+
+    std::vector<Preset> readAll() const;
+    static bool write(const juce::File& file, const std::vector<Preset>& presets);
+
+    // Maps the file for the length of the call, false without calling 'reader' if it isn't a bank
+    static bool use(const juce::File& file, const std::function<void(const PresetBank&)>& reader);
+    // Adds the preset to the file, replacing one of the same name. A missing file is created.
+    static bool save(const juce::File& file, const Preset& preset);
+
+    static juce::File getDefaultFile();
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    const char* data = nullptr;
+    size_t size = 0;
+    int numPresets = 0;
+    size_t namesOffset = 0;
+
+    static constexpr juce::uint32 magic = 0x425a5153;   // "SQZB" in memory
+    static constexpr int version = 1;
+    static constexpr size_t headerSize = 16;
+    static constexpr size_t entrySize = 24;
+
+    const char* getEntry(int index) const { return data + headerSize + (size_t) index * entrySize; }
+    static juce::CriticalSection& getFileLock();
+};
+
+/*
+ Everything the audio thread needs to switch to a preset in one go, designed ahead of time on
+ the message thread. The sections are only valid for the spec and stereo mode they were
+ designed for; the audio thread designs from 'parameters' itself when anything else runs.
+ */
+struct PresetRecall
+{
+    ChainParameters parameters, sideParameters;
+    // Butterworth only, other responses come from the audio thread's design table anyway
+    bool designed = false;
+    ChainSettings settings;
+    DesignSpec spec;
+    bool midSide = false;
+    CutSections lowCut, highCut, sideLowCut, sideHighCut;
+    int numLowCut = 0, numHighCut = 0, numSideLowCut = 0, numSideHighCut = 0;
+    // makeChainSettings' clamp memory after mapping the preset
+    double lastLowCut = 20.0, lastHighCut = 20000.0, lastSideLowCut = 20.0, lastSideHighCut = 20000.0;
+    int generation = 0;
+};
@@ -10,15 +10,15 @@
 #include "colors.h"
 
 ResponseCurveComponent::ResponseCurveComponent(SqueezeFilterAudioProcessor& p) : audioProcessor(p),
-leftPathProducer(audioProcessor.leftChannelFifo), rightPathProducer(audioProcessor.rightChannelFifo)
+leftPathProducer(audioProcessor.leftChannelFifo, static_cast<FFTOrder>(audioProcessor.getAnalyzerFFTOrder())),
+rightPathProducer(audioProcessor.rightChannelFifo, static_cast<FFTOrder>(audioProcessor.getAnalyzerFFTOrder()))
 {
+    audioProcessor.setEditorAnalyzerUsage(leftPathProducer.getMemoryBytes() + rightPathProducer.getMemoryBytes(),
+                                          leftPathProducer.getFFTSize());
+
     const auto& params = audioProcessor.getParameters();
     // Set freq response before timer starts
-    auto chainSettings = getChainSettings(audioProcessor.apvts,audioProcessor.lastLowCutParam,audioProcessor.lastHighCutParam);
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    updateResponseCurve();
     
     for(auto param : params)
     {
@@ -31,6 +31,7 @@ leftPathProducer(audioProcessor.leftChannelFifo), rightPathProducer(audioProcess
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    audioProcessor.setEditorAnalyzerUsage(0, 0);
     const auto& params = audioProcessor.getParameters();
     for(auto param : params)
     {
@@ -45,7 +46,7 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
 
 void PathProducer::process(juce::Rectangle<float> fftbounds, double sampleRate)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    SQUEEZE_TRACE_SCOPE("PathProducer::process");
 
     while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
     {
@@ -53,9 +54,6 @@ void PathProducer::process(juce::Rectangle<float> fftbounds, double sampleRate)
         {
             auto size = tempIncomingBuffer.getNumSamples();
 
-            // Create a separate copy of the tempIncomingBuffer to preserve the original audio data.
-            juce::AudioBuffer<float> originalBuffer(tempIncomingBuffer);
-
             // Calculate the RMS value of the incoming buffer.
             float sumOfSquares = 0.0f;
             for (int channel = 0; channel < tempIncomingBuffer.getNumChannels(); ++channel)
@@ -95,10 +93,9 @@ void PathProducer::process(juce::Rectangle<float> fftbounds, double sampleRate)
 
 //    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
 //    {
-//        std::vector<float> fftData;
-//        if (leftChannelFFTDataGenerator.getFFTData(fftData))
+//        if (leftChannelFFTDataGenerator.getFFTData(fftFrame))
 //        {
-//            pathProducer.generatePath(fftData, fftbounds, fftSize, binWidth, -48.f);
+//            pathProducer.generatePath(fftFrame, fftbounds, fftSize, binWidth, -48.f);
 //        }
 //    }
 //
@@ -115,11 +112,7 @@ void ResponseCurveComponent::timerCallback()
     if(parametersChanged.compareAndSetBool(false, true) || doOnce)
     {
         doOnce = !doOnce;
-        auto chainSettings = getChainSettings(audioProcessor.apvts,audioProcessor.lastLowCutParam,audioProcessor.lastHighCutParam);
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+        updateResponseCurve();
     }
     
     // FFT uncomment to use
@@ -133,8 +126,25 @@ void ResponseCurveComponent::timerCallback()
     repaint();
 }
 
+double ResponseCurveComponent::getDisplaySampleRate() const
+{
+    // The editor can open before prepareToPlay has given the processor a rate
+    auto sampleRate = audioProcessor.getSampleRate();
+    return sampleRate > 0.0 ? sampleRate : 44100.0;
+}
+
+void ResponseCurveComponent::updateResponseCurve()
+{
+    auto chainSettings = getChainSettings(audioProcessor.apvts,audioProcessor.lastLowCutParam,audioProcessor.lastHighCutParam);
+    auto spec = audioProcessor.getDesignSpec(chainSettings);
+    spec.sampleRate = getDisplaySampleRate();
+    numLowCutSections = designSpecCutSections(lowCutSections, true, chainSettings.lowCutFreq, spec);
+    numHighCutSections = designSpecCutSections(highCutSections, false, chainSettings.highCutFreq, spec);
+}
+
 void ResponseCurveComponent::paint (juce::Graphics& g)
 {
+    SQUEEZE_TRACE_SCOPE("ResponseCurveComponent::paint");
     using namespace juce;
     // (Our component is opaque, so we must completely fill the background with a solid colour)
    // g.fillAll (Colour::fromFloatRGBA (0.10f, 0.11f, 0.13f, 1.0f));
@@ -144,11 +154,7 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
    // auto bounds = getLocalBounds();
     auto responseArea = getAnalysisArea();
     auto w = responseArea.getWidth();
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-//    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-
-    auto sampleRate = audioProcessor.getSampleRate();
+    auto sampleRate = getDisplaySampleRate();
     
     std::vector<double> mags;
     mags.resize(w);
@@ -157,43 +163,12 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     {
         double mag = 1.f;
         auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-      
-//        if(!monoChain.isBypassed<ChainPositions::Peak>())
-//            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
         
-        if(!lowcut.isBypassed<0>())
-        {
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!lowcut.isBypassed<1>())
-        {
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!lowcut.isBypassed<2>())
-        {
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!lowcut.isBypassed<3>())
-        {
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+        for(int k = 0; k < numLowCutSections; ++k)
+            mag *= getMagnitudeForFrequency(lowCutSections[(size_t) k], freq, sampleRate);
         
-        if(!highcut.isBypassed<0>())
-        {
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!highcut.isBypassed<1>())
-        {
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!highcut.isBypassed<2>())
-        {
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(!highcut.isBypassed<3>())
-        {
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+        for(int k = 0; k < numHighCutSections; ++k)
+            mag *= getMagnitudeForFrequency(highCutSections[(size_t) k], freq, sampleRate);
         
         mags[i] = Decibels::gainToDecibels(mag);
     }
@@ -242,6 +217,7 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
 
 void ResponseCurveComponent::resized()
 {
+    SQUEEZE_TRACE_SCOPE("ResponseCurveComponent::resized");
     using namespace juce;
     background = Image(Image::PixelFormat::RGB, getWidth(),getHeight(), true);
     
@@ -61,13 +61,14 @@ struct FFTDataGenerator
         //convert them to decibels
         for( int i = 0; i < numBins; ++i )
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            renderData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
         }
         
-        fftDataFifo.push(fftData);
+        // Only the bins are queued, the other three quarters of fftData are FFT workspace
+        fftDataFifo.push(renderData);
     }
     
-    void changeOrder(FFTOrder newOrder)
+    void changeOrder(FFTOrder newOrder, int numSlots = AnalyzerBudget::frameQueueSlots)
     {
         //when you change order, recreate the window, forwardFFT, fifo, fftData
         //also reset the fifoIndex
@@ -81,17 +82,27 @@ struct FFTDataGenerator
         
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
+        renderData.clear();
+        renderData.resize(fftSize / 2, 0);
 
-        fftDataFifo.prepare(fftData.size());
+        fftDataFifo.prepare(renderData.size(), numSlots);
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
     bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    FFTOrder getOrder() const { return order; }
+    // The FFT engine's tables are estimated, see AnalyzerBudget::getProducerBytes
+    size_t getMemoryBytes() const
+    {
+        const auto fftSize = static_cast<size_t>(getFFTSize());
+        return (fftData.capacity() + renderData.capacity() + fftSize + 2 * fftSize) * sizeof(float)
+               + fftDataFifo.getMemoryBytes();
+    }
 private:
     FFTOrder order;
-    BlockType fftData;
+    BlockType fftData, renderData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
     std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
     
@@ -117,8 +128,10 @@ struct AnalyzerPathGenerator
 
         int numBins = (int)fftSize / 2;
 
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        // A line to per pathResolution bins, three floats each; reused from call to call
+        auto& p = generatedPath;
+        p.clear();
+        p.preallocateSpace(3 * (numBins / AnalyzerBudget::pathResolution + 1));
 
         auto map = [bottom, top, negativeInfinity](float v)
         {
@@ -135,7 +148,7 @@ struct AnalyzerPathGenerator
         
         p.startNewSubPath(0, y);
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+        const int pathResolution = AnalyzerBudget::pathResolution; //you can draw line-to's every 'pathResolution' pixels.
 
         for( int binNum = 1; binNum < numBins; binNum += pathResolution )
         {
@@ -152,7 +165,7 @@ struct AnalyzerPathGenerator
             }
         }
 
-        pathFifo.push(p);
+        pathFifo.pushBySwap(p);
     }
 
     int getNumPathsAvailable() const
@@ -160,31 +173,57 @@ struct AnalyzerPathGenerator
         return pathFifo.getNumAvailableForReading();
     }
 
+    // Swaps, path hands back the storage of the one it held
     bool getPath(PathType& path)
     {
-        return pathFifo.pull(path);
+        return pathFifo.pullBySwap(path);
+    }
+    
+    void setNumSlots(int numSlots) { pathFifo.setNumSlots(numSlots); }
+    // The queued paths and the one being generated, once they have all been through generatePath
+    size_t getMemoryBytes(FFTOrder order) const
+    {
+        return pathFifo.getMemoryBytes() + AnalyzerBudget::getPathBytes(order) * static_cast<size_t>(pathFifo.getNumSlots() + 1);
     }
 private:
     Fifo<PathType> pathFifo;
+    PathType generatedPath;
 };
 
     
 struct PathProducer
 {
-    PathProducer(SingleChannelSampleFifo<SqueezeFilterAudioProcessor::BlockType>& scff) : leftChannelFifo(&scff)
+    // The order comes from the processor's analyzer budget
+    PathProducer(SingleChannelSampleFifo<SqueezeFilterAudioProcessor::BlockType>& scff, FFTOrder order) : leftChannelFifo(&scff)
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order16384);
+        leftChannelFFTDataGenerator.changeOrder(order);
         monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        fftFrame.resize(static_cast<size_t>(leftChannelFFTDataGenerator.getFFTSize() / 2), 0);
+        tempIncomingBuffer.setSize(1, AnalyzerBudget::sampleChunk);
+        pathProducer.setNumSlots(AnalyzerBudget::frameQueueSlots);
         
     }
     void process(juce::Rectangle<float>fftbounds, double sampleRate);
     juce::Path getPath(){return leftChannelFFTPath;};
     
+    int getFFTSize() const { return leftChannelFFTDataGenerator.getFFTSize(); }
+    size_t getMemoryBytes() const
+    {
+        const auto order = leftChannelFFTDataGenerator.getOrder();
+        return leftChannelFFTDataGenerator.getMemoryBytes()
+               + pathProducer.getMemoryBytes(order) + AnalyzerBudget::getPathBytes(order)    // and the one drawn
+               + static_cast<size_t>(monoBuffer.getNumSamples() + tempIncomingBuffer.getNumSamples()) * sizeof(float)
+               + fftFrame.capacity() * sizeof(float);
+    }
+    
 private:
     
     SingleChannelSampleFifo<SqueezeFilterAudioProcessor::BlockType>* leftChannelFifo;
     
     juce::AudioBuffer<float> monoBuffer;
+    // Pulled into, so reading the fifos never allocates
+    juce::AudioBuffer<float> tempIncomingBuffer;
+    std::vector<float> fftFrame;
     
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
     
@@ -240,7 +279,12 @@ struct ResponseCurveComponent: juce::Component, juce::AudioProcessorParameter::L
 private:
     SqueezeFilterAudioProcessor& audioProcessor;
     juce::Atomic<bool>parametersChanged {false};
-    MonoChain monoChain;
+    
+    // The sections the processor runs for the current settings, used to draw the curve
+    CutSections lowCutSections, highCutSections;
+    int numLowCutSections = 0, numHighCutSections = 0;
+    void updateResponseCurve();
+    double getDisplaySampleRate() const;
 
     juce::Image background;
     
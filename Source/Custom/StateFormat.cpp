@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    StateFormat.cpp
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+
+juce::uint32 BinaryState::getIdHash(const juce::String& parameterID)
+{
+    // FNV-1a over the UTF-8 bytes, stable across platforms and JUCE versions
+    juce::uint32 hash = 2166136261u;
+    for(auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8>(*c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void BinaryState::attach(juce::AudioProcessorValueTreeState& apvts)
+{
+    entries.clear();
+    for(auto* p : apvts.processor.getParameters())
+        if(auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(p))
+            entries.push_back({ getIdHash(parameter->getParameterID()), parameter });
+
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.hash < b.hash; });
+    jassert(std::adjacent_find(entries.begin(), entries.end(),
+                               [](const auto& a, const auto& b) { return a.hash == b.hash; }) == entries.end());
+
+    restored.assign(entries.size(), 0);
+}
+
+void BinaryState::write(juce::MemoryBlock& destData, int editorWidth, int editorHeight, const juce::MemoryBlock& extension) const
+{
+    juce::MemoryOutputStream mos(destData, false);
+    mos.preallocate(headerSize + entrySize * (int) entries.size() + 4 + extension.getSize());
+
+    mos.writeInt(static_cast<int>(magic));
+    mos.writeShort(static_cast<short>(version));
+    mos.writeShort(static_cast<short>(entries.size()));
+    mos.writeInt(editorWidth);
+    mos.writeInt(editorHeight);
+
+    for(auto& entry : entries)
+    {
+        mos.writeInt(static_cast<int>(entry.hash));
+        mos.writeFloat(entry.parameter->getValue());
+    }
+
+    if(! extension.isEmpty())
+    {
+        mos.writeInt(static_cast<int>(extension.getSize()));
+        mos.write(extension.getData(), extension.getSize());
+    }
+}
+
+bool BinaryState::isBinaryState(const void* data, int sizeInBytes)
+{
+    return data != nullptr && sizeInBytes >= headerSize
+        && juce::ByteOrder::littleEndianInt(data) == magic;
+}
+
+juce::MemoryBlock BinaryState::getExtension(const void* data, int sizeInBytes)
+{
+    if(! isBinaryState(data, sizeInBytes))
+        return {};
+
+    auto* bytes = static_cast<const char*>(data);
+    const auto extensionStart = headerSize + static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6)) * entrySize;
+    if(sizeInBytes < extensionStart + 4)
+        return {};
+
+    const auto size = static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + extensionStart));
+    if(size <= 0 || size > sizeInBytes - extensionStart - 4)
+        return {};
+    return juce::MemoryBlock(bytes + extensionStart + 4, static_cast<size_t>(size));
+}
+
+bool BinaryState::read(const void* data, int sizeInBytes, int& editorWidth, int& editorHeight)
+{
+    if(! isBinaryState(data, sizeInBytes))
+        return false;
+
+    auto* bytes = static_cast<const char*>(data);
+    const auto numEntries = static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6));
+    if(sizeInBytes < headerSize + numEntries * entrySize)
+        return false;
+
+    editorWidth = static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + 8));
+    editorHeight = static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + 12));
+
+    std::fill(restored.begin(), restored.end(), 0);
+
+    for(int i = 0; i < numEntries; ++i)
+    {
+        auto* entryData = bytes + headerSize + i * entrySize;
+        const auto hash = juce::ByteOrder::littleEndianInt(entryData);
+
+        auto found = std::lower_bound(entries.begin(), entries.end(), hash,
+                                      [](const Entry& entry, juce::uint32 h) { return entry.hash < h; });
+        if(found == entries.end() || found->hash != hash)
+            continue;
+
+        const auto bits = juce::ByteOrder::littleEndianInt(entryData + 4);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        found->parameter->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+        restored[(size_t) std::distance(entries.begin(), found)] = 1;
+    }
+
+    for(size_t k = 0; k < entries.size(); ++k)
+        if(restored[k] == 0)
+            entries[k].parameter->setValueNotifyingHost(entries[k].parameter->getDefaultValue());
+
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    StateFormat.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ The session state as a fixed layout binary blob, little endian:
+
+   uint32  magic "SQZS"
+   uint16  version
+   uint16  number of parameter entries
+   int32   editor width, int32 editor height
+   then per parameter: uint32 FNV-1a hash of the id, float normalised value
+   then optionally: uint32 size, and that many bytes of extension data (morph snapshots)
+
+ Entries are found by id hash, so parameters can be added or reordered in later versions;
+ unknown hashes are skipped and parameters missing from a blob go back to their defaults,
+ the same as replaceState does. Restoring walks the blob once and sets each parameter, with
+ no ValueTree or XML built on the way.
+ */
+class BinaryState
+{
+public:
+    static constexpr juce::uint32 magic = 0x535a5153;   // "SQZS" in memory
+    static constexpr int version = 1;
+
+    static juce::uint32 getIdHash(const juce::String& parameterID);
+
+    // Builds the hash index once, from the constructor
+    void attach(juce::AudioProcessorValueTreeState& apvts);
+
+    void write(juce::MemoryBlock& destData, int editorWidth, int editorHeight, const juce::MemoryBlock& extension = {}) const;
+
+    // False when the data is not in this format, for example an older ValueTree blob
+    bool read(const void* data, int sizeInBytes, int& editorWidth, int& editorHeight);
+
+    static bool isBinaryState(const void* data, int sizeInBytes);
+    // Whatever write() was given as the extension, empty for blobs written without one
+    static juce::MemoryBlock getExtension(const void* data, int sizeInBytes);
+
+private:
+    struct Entry
+    {
+        juce::uint32 hash;
+        juce::RangedAudioParameter* parameter;
+    };
+
+    std::vector<Entry> entries;    // sorted by hash
+    std::vector<char> restored;    // per entry, reused by every read
+
+    static constexpr int headerSize = 16;
+    static constexpr int entrySize = 8;
+};
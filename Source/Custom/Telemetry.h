@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    Telemetry.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Build with SQUEEZE_TELEMETRY=0 to compile the measurements out, every call becomes a no-op
+#ifndef SQUEEZE_TELEMETRY
+ #define SQUEEZE_TELEMETRY 1
+#endif
+
+struct TelemetrySnapshot
+{
+    // processBlock time as a proportion of the block's duration
+    double meanLoad = 0.0, p99Load = 0.0, maxLoad = 0.0, smoothedLoad = 0.0;
+    juce::uint64 numBlocks = 0, numOverruns = 0, numRedesigns = 0, numAnalyzerOverflows = 0;
+
+    juce::String toString() const
+    {
+        auto percent = [](double load) { return juce::String(load * 100.0, 1) + "%"; };
+        return "DSP " + percent(smoothedLoad) + " (mean " + percent(meanLoad) + ", p99 " + percent(p99Load)
+             + ", max " + percent(maxLoad) + "), " + juce::String(numOverruns) + " overruns, "
+             + juce::String(numRedesigns) + " redesigns, " + juce::String(numAnalyzerOverflows) + " analyzer drops";
+    }
+};
+
+/*
+ Per instance processBlock timing against the block deadline. The audio thread reads the high
+ resolution clock twice per block and bumps a histogram bucket; everything is a relaxed atomic
+ written only by that thread, so readers on any other thread get a slightly stale but never
+ torn view. The histogram is in 1% steps of the deadline, so p99 is exact to 1%.
+ */
+class DspTelemetry
+{
+public:
+   #if SQUEEZE_TELEMETRY
+    // Not while the audio thread is running, from prepareToPlay
+    void prepare(double sampleRate, int maximumBlockSize)
+    {
+        measurer.reset(sampleRate, maximumBlockSize);
+        msPerSample = 1000.0 / sampleRate;
+        for(auto& bucket : histogram)
+            bucket.store(0, std::memory_order_relaxed);
+        numBlocks.store(0, std::memory_order_relaxed);
+        numRedesigns.store(0, std::memory_order_relaxed);
+        loadSum.store(0.0, std::memory_order_relaxed);
+        maxLoad.store(0.0, std::memory_order_relaxed);
+    }
+
+    struct ScopedBlock
+    {
+        ScopedBlock(DspTelemetry& t, int n) noexcept : telemetry(t), numSamples(n), start(juce::Time::getHighResolutionTicks()) {}
+        ~ScopedBlock() { telemetry.addBlock(juce::Time::getHighResolutionTicks() - start, numSamples); }
+
+        DspTelemetry& telemetry;
+        const int numSamples;
+        const juce::int64 start;
+    };
+
+    // For updates that changed the coefficients, not every call to updateFilters
+    void countRedesign() noexcept { increment(numRedesigns); }
+
+    // Any thread. Analyzer drops are left for the owner to fill in, the fifos count those.
+    TelemetrySnapshot getSnapshot() const
+    {
+        TelemetrySnapshot snapshot;
+        snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+        snapshot.numRedesigns = numRedesigns.load(std::memory_order_relaxed);
+        snapshot.numOverruns = static_cast<juce::uint64>(measurer.getXRunCount());
+        snapshot.smoothedLoad = measurer.getLoadAsProportion();
+        snapshot.maxLoad = maxLoad.load(std::memory_order_relaxed);
+
+        std::array<juce::uint32, numBuckets> counts;
+        juce::uint64 total = 0;
+        for(size_t b = 0; b < counts.size(); ++b)
+            total += (counts[b] = histogram[b].load(std::memory_order_relaxed));
+
+        if(total == 0)
+            return snapshot;
+
+        snapshot.meanLoad = loadSum.load(std::memory_order_relaxed) / static_cast<double>(snapshot.numBlocks > 0 ? snapshot.numBlocks : 1);
+
+        const auto target = total - total / 100;
+        juce::uint64 seen = 0;
+        for(size_t b = 0; b < counts.size(); ++b)
+        {
+            seen += counts[b];
+            if(seen >= target)
+            {
+                snapshot.p99Load = (static_cast<double>(b) + 1.0) / 100.0;
+                break;
+            }
+        }
+        return snapshot;
+    }
+
+private:
+    // 0-255% of the deadline, the last bucket takes everything beyond
+    static constexpr int numBuckets = 256;
+    std::array<std::atomic<juce::uint32>, numBuckets> histogram {};
+    std::atomic<juce::uint64> numBlocks {0}, numRedesigns {0};
+    std::atomic<double> loadSum {0.0}, maxLoad {0.0};
+    juce::AudioProcessLoadMeasurer measurer;
+    double msPerSample = 0.0;
+
+    // Single writer, so a plain load and store instead of a locked read-modify-write
+    template<typename T>
+    static void increment(std::atomic<T>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void addBlock(juce::int64 ticks, int numSamples) noexcept
+    {
+        if(numSamples <= 0 || msPerSample <= 0.0)
+            return;
+
+        const auto milliseconds = juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+        measurer.registerRenderTime(milliseconds, numSamples);
+
+        const auto load = milliseconds / (msPerSample * numSamples);
+        const auto bucket = juce::jlimit(0, numBuckets - 1, static_cast<int>(load * 100.0));
+        increment(histogram[(size_t) bucket]);
+        increment(numBlocks);
+        loadSum.store(loadSum.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+        if(load > maxLoad.load(std::memory_order_relaxed))
+            maxLoad.store(load, std::memory_order_relaxed);
+    }
+   #else
+    void prepare(double, int) {}
+    struct ScopedBlock { ScopedBlock(DspTelemetry&, int) noexcept {} };
+    void countRedesign() noexcept {}
+    TelemetrySnapshot getSnapshot() const { return {}; }
+   #endif
+};
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    Trace.cpp
+
+  ==============================================================================
+*/
+
+#include "Trace.h"
+
+std::atomic<Tracer*> Tracer::active {nullptr};
+std::atomic<int> Tracer::sessionCounter {0};
+
+Tracer::Tracer() : juce::Thread("Trace writer")
+{
+    const auto path = juce::SystemStats::getEnvironmentVariable("SQUEEZE_TRACE", {});
+    if(path.isNotEmpty())
+        start(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+}
+
+Tracer::~Tracer()
+{
+    stop();
+}
+
+bool Tracer::start(const juce::File& file)
+{
+    if(getActive() != nullptr)
+        return false;
+
+    file.deleteFile();
+    output = std::make_unique<juce::FileOutputStream>(file);
+    if(output->failedToOpen())
+    {
+        output.reset();
+        return false;
+    }
+
+    for(auto& ring : rings)
+    {
+        ring.events.resize(ThreadRing::capacity);
+        ring.writeIndex.store(0);
+        ring.readIndex.store(0);
+        ring.numDropped.store(0);
+        ring.isMessageThread = false;
+        ring.firstName = nullptr;
+    }
+    numClaimed.store(0);
+    session = ++sessionCounter;
+    originTicks = juce::Time::getHighResolutionTicks();
+    firstEvent = true;
+
+    *output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    active.store(this, std::memory_order_release);
+    startThread(juce::Thread::Priority::low);
+    return true;
+}
+
+void Tracer::stop()
+{
+    if(! isRunning())
+        return;
+
+    // Scopes still open finish into the rings, nobody reads them after this
+    active.store(nullptr, std::memory_order_release);
+    stopThread(1000);
+
+    flush();
+    writeThreadNames();
+    *output << "\n]}\n";
+    output.reset();
+}
+
+juce::uint64 Tracer::getNumDropped() const
+{
+    juce::uint64 total = 0;
+    for(auto& ring : rings)
+        total += ring.numDropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+Tracer::ThreadRing* Tracer::getRingForThisThread(const char* name) noexcept
+{
+    struct Claim
+    {
+        const Tracer* tracer = nullptr;
+        int session = 0;
+        ThreadRing* ring = nullptr;
+    };
+    thread_local Claim claim;
+
+    if(claim.tracer != this || claim.session != session)
+    {
+        const auto index = numClaimed.fetch_add(1, std::memory_order_relaxed);
+        claim = { this, session, index < maxThreads ? &rings[(size_t) index] : nullptr };
+        if(claim.ring != nullptr)
+        {
+            claim.ring->isMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+            claim.ring->firstName = name;
+        }
+    }
+    return claim.ring;
+}
+
+void Tracer::record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    auto* ring = getRingForThisThread(name);
+    if(ring == nullptr)
+        return;
+
+    // Single producer, single consumer: only this thread moves writeIndex
+    const auto write = ring->writeIndex.load(std::memory_order_relaxed);
+    if(write - ring->readIndex.load(std::memory_order_acquire) >= (juce::uint32) ThreadRing::capacity)
+    {
+        ring->numDropped.store(ring->numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring->events[(size_t) (write & (ThreadRing::capacity - 1))] = { name, startTicks, endTicks };
+    ring->writeIndex.store(write + 1, std::memory_order_release);
+}
+
+void Tracer::run()
+{
+    while(! threadShouldExit())
+    {
+        flush();
+        wait(100);
+    }
+}
+
+void Tracer::flush()
+{
+    const auto ticksPerMicrosecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / 1.0e6;
+    const auto numRings = juce::jmin(numClaimed.load(std::memory_order_relaxed), maxThreads);
+
+    for(int r = 0; r < numRings; ++r)
+    {
+        auto& ring = rings[(size_t) r];
+        const auto write = ring.writeIndex.load(std::memory_order_acquire);
+        auto read = ring.readIndex.load(std::memory_order_relaxed);
+
+        for(; read != write; ++read)
+        {
+            const auto& event = ring.events[(size_t) (read & (ThreadRing::capacity - 1))];
+            *output << (firstEvent ? "\n" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r + 1
+                    << ",\"ts\":" << juce::String(static_cast<double>(event.startTicks - originTicks) / ticksPerMicrosecond, 3)
+                    << ",\"dur\":" << juce::String(static_cast<double>(event.endTicks - event.startTicks) / ticksPerMicrosecond, 3)
+                    << "}";
+            firstEvent = false;
+        }
+        ring.readIndex.store(read, std::memory_order_release);
+    }
+    output->flush();
+}
+
+void Tracer::writeThreadNames()
+{
+    const auto numRings = juce::jmin(numClaimed.load(std::memory_order_relaxed), maxThreads);
+    for(int r = 0; r < numRings; ++r)
+    {
+        // Other threads are named after their first event, the host's audio thread is the processBlock one
+        auto& ring = rings[(size_t) r];
+        const auto name = ring.isMessageThread ? juce::String("Message thread")
+                                               : juce::String(ring.firstName) + " thread";
+        *output << (firstEvent ? "\n" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r + 1
+                << ",\"args\":{\"name\":\"" << name << "\"}}";
+        firstEvent = false;
+    }
+
+    if(getNumDropped() > 0)
+        DBG("Trace dropped " << (juce::int64) getNumDropped() << " events, the writer fell behind");
+}
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    Trace.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Build with SQUEEZE_TRACE=0 to compile the trace scopes out altogether
+#ifndef SQUEEZE_TRACE
+ #define SQUEEZE_TRACE 1
+#endif
+
+/*
+ Opt-in Chrome trace (chrome://tracing, ui.perfetto.dev) of scoped events across every thread
+ the plugin runs on, so one timeline shows whether a stall sits on the audio thread, the
+ editor's timer or a state load.
+
+ Each thread writes into its own fixed ring, claimed from a preallocated pool on its first
+ event, so recording is two clock reads and a store with no locks or allocation. A background
+ thread drains the rings into the JSON file. A full ring drops events and counts them.
+
+ Shared between instances through juce::SharedResourcePointer. Tracing starts when the
+ SQUEEZE_TRACE environment variable names the output file, or through start(); with neither,
+ a scope costs one atomic load.
+ */
+class Tracer : private juce::Thread
+{
+public:
+    Tracer();
+    ~Tracer() override;
+
+    // Message thread. Ignored while a trace is already being written.
+    bool start(const juce::File& file);
+    void stop();
+    bool isRunning() const { return getActive() == this; }
+
+    // Events lost to full rings since start()
+    juce::uint64 getNumDropped() const;
+
+    // The tracer scopes record into, nullptr when none is running
+    static Tracer* getActive() noexcept { return active.load(std::memory_order_acquire); }
+
+    // Any thread. 'name' has to be a string literal, only the pointer is kept.
+    void record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+private:
+    struct Event
+    {
+        const char* name;
+        juce::int64 startTicks, endTicks;
+    };
+
+    struct ThreadRing
+    {
+        static constexpr int capacity = 8192;
+        std::vector<Event> events;
+        std::atomic<juce::uint32> writeIndex {0}, readIndex {0};   // wrap around, capacity is a power of 2
+        std::atomic<juce::uint64> numDropped {0};
+        bool isMessageThread = false;
+        const char* firstName = nullptr;                           // labels the thread in the viewer
+    };
+
+    static constexpr int maxThreads = 16;
+    static std::atomic<Tracer*> active;
+    static std::atomic<int> sessionCounter;
+
+    std::array<ThreadRing, maxThreads> rings;
+    std::atomic<int> numClaimed {0};
+    int session = 0;
+    juce::int64 originTicks = 0;
+
+    std::unique_ptr<juce::FileOutputStream> output;
+    bool firstEvent = true;
+
+    ThreadRing* getRingForThisThread(const char* name) noexcept;
+    void run() override;
+    void flush();
+    void writeThreadNames();
+};
+
+struct TraceScope
+{
+    explicit TraceScope(const char* eventName) noexcept
+        : tracer(Tracer::getActive()), name(eventName), startTicks(tracer != nullptr ? juce::Time::getHighResolutionTicks() : 0) {}
+
+    ~TraceScope()
+    {
+        if(tracer != nullptr)
+            tracer->record(name, startTicks, juce::Time::getHighResolutionTicks());
+    }
+
+    Tracer* const tracer;
+    const char* const name;
+    const juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceScope)
+};
+
+#if SQUEEZE_TRACE
+ #define SQUEEZE_TRACE_SCOPE(name) const TraceScope JUCE_JOIN_MACRO(traceScope, __LINE__) (name)
+#else
+ #define SQUEEZE_TRACE_SCOPE(name)
+#endif
@@ -11,7 +11,7 @@
 
 //==============================================================================
 SqueezeFilterAudioProcessorEditor::SqueezeFilterAudioProcessorEditor (SqueezeFilterAudioProcessor& p) : AudioProcessorEditor (&p), audioProcessor
-    (p) ,lpHpSlider(juce::Slider::SliderStyle::TwoValueHorizontal, p.apvts.getParameter("hp"), p.apvts.getParameter("lp")),lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCutSlope", lowCutSlopeSlider),highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCutSlope", highCutSlopeSlider),squeezeSliderAttachment(audioProcessor.apvts, "SqueezeValue", squeezeSlider),offsetSliderAttachment(audioProcessor.apvts, "OffsetValue", offsetSlider) /*analyzerEnabledButtonAttachment(audioProcessor.apvts, "AnalyzerEnabled", analyzerEnabledButton) */,responseCurveComponent(audioProcessor)
+    (p) ,lpHpSlider(juce::Slider::SliderStyle::TwoValueHorizontal, p.apvts.getParameter("hp"), p.apvts.getParameter("lp")),lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCutSlope", lowCutSlopeSlider),highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCutSlope", highCutSlopeSlider),squeezeSliderAttachment(audioProcessor.apvts, "SqueezeValue", squeezeSlider),offsetSliderAttachment(audioProcessor.apvts, "OffsetValue", offsetSlider) /*analyzerEnabledButtonAttachment(audioProcessor.apvts, "AnalyzerEnabled", analyzerEnabledButton) */,responseCurveComponent(audioProcessor),loadMeter(audioProcessor),levelMeters(audioProcessor),loudnessDisplay(audioProcessor)
 
 {
     
@@ -163,7 +163,10 @@ void SqueezeFilterAudioProcessorEditor::resized()
    
     //buttonArea
     zoomOneButton.setBounds(menuButtons.reduced(10));
-    bounds = bounds.removeFromRight(bounds.getWidth() * 0.95f);
+    loadMeter.setBounds(topRec.removeFromRight(topRec.getWidth() * 0.3f));
+    loudnessDisplay.setBounds(topRec.removeFromRight(topRec.getWidth() * 0.3f));
+    auto meterArea = bounds.removeFromLeft(bounds.getWidth() * 0.05f);
+    levelMeters.setBounds(meterArea.removeFromTop(meterArea.getHeight() * 0.8f).reduced(4, 8));
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.8f);
     auto topSliderArea = responseArea.removeFromTop(responseArea.getHeight()* 0.3f);
     auto labelarea = topSliderArea.removeFromRight(bounds.getWidth() * 0.15f);
@@ -213,7 +216,12 @@ std::vector<juce::Component*> SqueezeFilterAudioProcessorEditor::getComps()
         &squeezeSlider,
         &offsetSlider,
       //  &analyzerEnabledButton,
-        &responseCurveComponent
+        &responseCurveComponent,
+        &levelMeters,
+        &loudnessDisplay,
+       #if SQUEEZE_TELEMETRY
+        &loadMeter
+       #endif
     };
 }
 
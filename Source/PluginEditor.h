@@ -15,6 +15,7 @@
 #include "Custom/SvgComps.h"
 #include "Custom/ResponseComp.h"
 #include "Custom/colors.h"
+#include "Custom/Meters.h"
 using namespace juce;
 
 
@@ -75,6 +76,9 @@ private:
     //ButtonAttachment analyzerEnabledButtonAttachment;
 
     ResponseCurveComponent responseCurveComponent;
+    LoadMeter loadMeter;
+    LevelMeters levelMeters;
+    LoudnessDisplay loudnessDisplay;
     std::vector<juce::Component*> getComps();
 
     // Move LAF to its own component/file
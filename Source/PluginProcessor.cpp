@@ -16,12 +16,15 @@ SqueezeFilterAudioProcessor::SqueezeFilterAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
-{}
+{
+    binaryState.attach(apvts);
+}
 
 SqueezeFilterAudioProcessor::~SqueezeFilterAudioProcessor()
 {}
@@ -61,7 +64,9 @@ bool SqueezeFilterAudioProcessor::isMidiEffect() const
 
 double SqueezeFilterAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // How long the current cuts take to ring out to -120 dB
+    const auto sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? tailSamples.load() / sampleRate : 0.0;
 }
 
 int SqueezeFilterAudioProcessor::getNumPrograms()
@@ -94,25 +99,64 @@ void SqueezeFilterAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
-    rmsLevelLeft.reset(sampleRate, 2.02);
-    rmsLevelRight.reset(sampleRate, 2.02);
+    telemetry.prepare(sampleRate, samplesPerBlock);
+    lastDesignCounts.fill(-1);
+    lastDesignBands.numBands = 0;
+    diagnostics.log(LogEvent::Prepared, static_cast<float>(sampleRate), 0.0f, samplesPerBlock);
+    lastLoggedSections = -1;
+    clampLogged = {};
+    
+    inputMeter.prepare(sampleRate);
+    outputMeter.prepare(sampleRate);
+    inputLoudness.prepare(sampleRate, getChannelLayoutOfBus(true, 0));
+    outputLoudness.prepare(sampleRate, getChannelLayoutOfBus(false, 0));
+    
+    channelCascade.setNumChannels(static_cast<size_t>(getMainBusNumInputChannels()));
+    for(auto& cascade : pipelinedCascades)
+    {
+        cascade.setNumSections(pipelinedCascades[0].numLanes);
+        cascade.reset();
+    }
     
-    rmsLevelLeft.setCurrentAndTargetValue(-48.f);
-    rmsLevelRight.setCurrentAndTargetValue(-48.f);
+    lfo.prepare(sampleRate);
+    sidechainFollower.prepare(sampleRate);
     
-    juce::dsp::ProcessSpec spec;
+    // Workers only exist for wide buses, the ParallelChannels switch decides per block
+    const auto numGroups = static_cast<int>(channelCascade.getNumGroups());
+    if(getMainBusNumInputChannels() >= parallelChannelThreshold)
+        channelWorkers.start(juce::jmin(numGroups - 1, juce::SystemStats::getNumCpus() - 1, 7));
+    else
+        channelWorkers.stop();
     
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    cutTables = CutLookupTables::getForSampleRate(sampleRate);
+    multiband.prepare(sampleRate, getMainBusNumInputChannels(), cutTables.get());
+    // Same size as the live one, so taking a snapshot reuses its storage
+    fadingMultiband.prepare(sampleRate, getMainBusNumInputChannels(), cutTables.get());
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // The first update sets the path up directly, there is nothing to fade from yet
+    fadeBuffer.setSize(getMainBusNumInputChannels(), juce::roundToInt(sampleRate * fadeSeconds));
+    fadeLength = fadeBuffer.getNumSamples();
+    fadeRemaining = 0;
+    inputHistory.setSize(getMainBusNumInputChannels(), fadeLength);
+    inputHistory.clear();
+    historyPosition = 0;
+    prewarmPending = false;
+    hasPathLayout = false;
+    recallPending = false;
+    recallArrived = false;
+    if(getNumMorphSnapshots() > 0)
+        requestMorphGridRebuild();
     
+    bypassActive = isBypassed();
+    multibandActive = isMultiband() && ! bypassActive;
+    lastHostValues = getHostValues();
+    midSideActive = isMidSide();
     updateFilters();
     
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    // Small fixed chunks, however large the host's blocks are
+    const auto analyzerSlots = AnalyzerBudget::getSampleQueueSlots(sampleRate);
+    leftChannelFifo.prepare(AnalyzerBudget::sampleChunk, analyzerSlots);
+    rightChannelFifo.prepare(AnalyzerBudget::sampleChunk, analyzerSlots);
 
 }
 
@@ -121,7 +165,15 @@ void SqueezeFilterAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    channelWorkers.stop();
+}
+
+#if SQUEEZE_HAS_AUDIO_WORKGROUP
+void SqueezeFilterAudioProcessor::audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup)
+{
+    channelWorkers.setWorkgroup(workgroup);
 }
+#endif
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SqueezeFilterAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -130,18 +182,25 @@ bool SqueezeFilterAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works, from mono up to maxChannels, since every channel gets the same filter
+    if (layouts.getMainOutputChannelSet().isDisabled()
+     || layouts.getMainOutputChannelSet().size() > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // The sidechain is optional, but when it is connected it has to be mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechain = layouts.getChannelSet (true, 1);
+        if (! sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -152,29 +211,180 @@ bool SqueezeFilterAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
 void SqueezeFilterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    const DspTelemetry::ScopedBlock timing(telemetry, buffer.getNumSamples());
+    SQUEEZE_TRACE_SCOPE("processBlock");
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
+    auto totalNumOutputChannels = getMainBusNumOutputChannels();
     
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
-    if(totalNumInputChannels > 1)
+    if(totalNumInputChannels > 0)
     {
-        updateFilters();
+        auto mainBuffer = getBusBuffer(buffer, true, 0);
+        juce::dsp::AudioBlock<float> block(mainBuffer);
+        
+        if(skipSilence(mainBuffer))
+        {
+            // Both sides are silent now, the meters fall with the rest
+            inputMeter.process(mainBuffer, 0, mainBuffer.getNumSamples());
+            outputMeter.process(mainBuffer, 0, mainBuffer.getNumSamples());
+            inputLoudness.processSilence(mainBuffer.getNumSamples());
+            outputLoudness.processSilence(mainBuffer.getNumSamples());
+            return;
+        }
         
-        juce::dsp::AudioBlock<float> block(buffer);
-        auto leftBlock = block.getSingleChannelBlock(0);
-        auto rightBlock = block.getSingleChannelBlock(1);
+        pickUpRecall();
         
-        juce::dsp::ProcessContextReplacing<float>leftContext(leftBlock);
-        juce::dsp::ProcessContextReplacing<float>rightContext(rightBlock);
+        // Changes of path are picked up by updateFilters, which fades them in
+        bypassActive = hostBypassing || isBypassed();
+        multibandActive = isMultiband() && ! bypassActive;
+        midSideActive = isMidSide();
         
-        leftChain.process(leftContext);
-        rightChain.process(rightContext);
+        parallelActive = channelWorkers.getNumWorkers() > 0
+                      && apvts.getRawParameterValue("ParallelChannels")->load() > 0.5f;
+        
+        const auto modulated = isModulated();
+        // A recall is a jump, the path fade covers it instead of a ramp
+        const auto ramp = recallPending ? ChainModulation() : getParameterRamp();
+        
+        if(modulated)
+        {
+            lfo.setParameters(static_cast<int>(apvts.getRawParameterValue("LfoRate")->load()),
+                              static_cast<LfoShape>(apvts.getRawParameterValue("LfoShape")->load()));
+            lfo.syncToPlayHead(getPlayHead());
+            sidechainFollower.setParameters(apvts.getRawParameterValue("SidechainAttack")->load(),
+                                            apvts.getRawParameterValue("SidechainRelease")->load(),
+                                            static_cast<EnvelopeMode>(apvts.getRawParameterValue("SidechainMode")->load()));
+        }
+        
+        if(modulated || ! ramp.isZero())
+        {
+            // An empty buffer when the sidechain is disconnected, the follower is skipped then
+            auto sidechainBuffer = modulated && isSidechainActive() ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
+            
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            for(int start = 0; start < numSamples; start += modulationBlockSize)
+            {
+                const auto subBlockSize = juce::jmin(modulationBlockSize, numSamples - start);
+                
+                // The ramp has run out by the end of the block, where the host value applies
+                const auto remaining = 1.0f - static_cast<float>(start + subBlockSize) / static_cast<float>(numSamples);
+                updateFilters(modulated ? getNextModulation(sidechainBuffer, start, subBlockSize) : ChainModulation(),
+                              ramp.scaled(remaining));
+                
+                processTile(mainBuffer, start, subBlockSize);
+            }
+        }
+        else
+        {
+            updateFilters();
+            
+            // Big offline blocks go through in tiles of l1CacheBytes across all channels, each one
+            // filtered, metered and handed to the analyzer before the next. The gain over whole
+            // block passes is unmeasured; SqueezeRender --block 2048 / 8192 is the way to check.
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            const auto bytesPerSample = static_cast<int>(sizeof(float)) * totalNumInputChannels;
+            const auto tileSize = juce::jmax(modulationBlockSize, l1CacheBytes / bytesPerSample / modulationBlockSize * modulationBlockSize);
+            
+            for(int start = 0; start < numSamples; start += tileSize)
+                processTile(mainBuffer, start, juce::jmin(tileSize, numSamples - start));
+        }
+        
+        logAnalyzerOverflows();
+    }
+    
+}
+
+void SqueezeFilterAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Only hosts that ignore the bypass parameter get here, the same fade applies
+    const juce::ScopedValueSetter<bool> bypassing(hostBypassing, true);
+    processBlock(buffer, midiMessages);
+}
+
+juce::AudioProcessorParameter* SqueezeFilterAudioProcessor::getBypassParameter() const
+{
+    return apvts.getParameter("Bypass");
+}
+
+void SqueezeFilterAudioProcessor::processTile(juce::AudioBuffer<float>& mainBuffer, int startSample, int numSamples)
+{
+    juce::dsp::AudioBlock<float> block(mainBuffer);
+    auto tile = block.getSubBlock(static_cast<size_t>(startSample), static_cast<size_t>(numSamples));
+    
+    inputMeter.process(mainBuffer, startSample, numSamples);
+    inputLoudness.process(mainBuffer, startSample, numSamples);
+    
+    // Coefficients are set by now, the new path catches up on recent input before this tile
+    if(std::exchange(prewarmPending, false))
+        prewarmPath();
+    pushInputHistory(mainBuffer, startSample, numSamples);
+    
+    // While a path change fades in, the old path runs on a copy of the input
+    const auto numFading = juce::jmin(numSamples, fadeRemaining);
+    if(numFading > 0)
+        for(int ch = 0; ch < mainBuffer.getNumChannels(); ++ch)
+            fadeBuffer.copyFrom(ch, 0, mainBuffer, ch, startSample, numFading);
+    
+    processChains(tile);
+    
+    if(numFading > 0)
+    {
+        juce::dsp::AudioBlock<float> fadeBlock(fadeBuffer);
+        auto oldTile = fadeBlock.getSubBlock(0, static_cast<size_t>(numFading));
+        processFadingPath(oldTile);
         
-        leftChannelFifo.update(buffer);
-        rightChannelFifo.update(buffer);
+        const auto fadePosition = fadeLength - fadeRemaining;
+        for(int ch = 0; ch < mainBuffer.getNumChannels(); ++ch)
+        {
+            auto* newPath = mainBuffer.getWritePointer(ch, startSample);
+            auto* oldPath = fadeBuffer.getReadPointer(ch);
+            for(int i = 0; i < numFading; ++i)
+            {
+                const auto gain = static_cast<float>(fadePosition + i + 1) / static_cast<float>(fadeLength);
+                newPath[i] = oldPath[i] + gain * (newPath[i] - oldPath[i]);
+            }
+        }
+        fadeRemaining -= numFading;
     }
     
+    outputMeter.process(mainBuffer, startSample, numSamples);
+    outputLoudness.process(mainBuffer, startSample, numSamples);
+    
+    // Channel names are swapped in the fifo, Right reads channel 0
+    rightChannelFifo.update(mainBuffer.getReadPointer(0, startSample), numSamples);
+    if(mainBuffer.getNumChannels() > 1)
+        leftChannelFifo.update(mainBuffer.getReadPointer(1, startSample), numSamples);
+}
+
+void SqueezeFilterAudioProcessor::processChains(juce::dsp::AudioBlock<float>& block)
+{
+    if(multibandActive)
+    {
+        multiband.process(block);
+        return;
+    }
+    
+    if(usePipeline)
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        for(size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            pipelinedCascades[ch].process(block.getChannelPointer(ch), numSamples);
+        return;
+    }
+    
+    // Bypassed on the channel kernel: no sections, nothing to do
+    if(pathLayout.kind == PathKind::Channel && ! pathLayout.midSide && pathLayout.counts == std::array<int, 4> {})
+        return;
+    
+    if(parallelActive)
+    {
+        auto processGroup = [this, &block](int group) { channelCascade.processGroup(block, static_cast<size_t>(group)); };
+        channelWorkers.run(static_cast<int>(channelCascade.getNumGroups()), processGroup);
+        return;
+    }
+    
+    channelCascade.process(block);
 }
 
 //==============================================================================
@@ -192,33 +402,38 @@ juce::AudioProcessorEditor* SqueezeFilterAudioProcessor::createEditor()
 //==============================================================================
 void SqueezeFilterAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    // Fixed layout binary, see StateFormat.h. Sessions saved as a ValueTree still load.
+    binaryState.write(destData, editorWidth, editorHeight, getMorphState());
 }
 
 void SqueezeFilterAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if(tree.isValid())
+    SQUEEZE_TRACE_SCOPE("setStateInformation");
+    // The next block redesigns the filters, updateFilters() belongs to the audio thread
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    
+    if(binaryState.read(data, sizeInBytes, editorWidth, editorHeight))
     {
-        apvts.replaceState(tree);
-        updateFilters();
+        setMorphState(BinaryState::getExtension(data, sizeInBytes));
     }
+    else
+    {
+        auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+        if(tree.isValid())
+        {
+            auto size = tree.getChildWithName("lastSize");
+            editorWidth = size.getProperty("width", editorWidth);
+            editorHeight = size.getProperty("height", editorHeight);
+            apvts.replaceState(tree);
+            setMorphState({});
+        }
+    }
+    
+    const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+    lastStateLoadMicroseconds = juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6;
 }
 
 
-// Filter coefficients
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
-{
-    *old = *replacements;
-}
-
 juce::AudioProcessorValueTreeState::ParameterLayout SqueezeFilterAudioProcessor::createParameterLayout(){
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
@@ -236,6 +451,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout SqueezeFilterAudioProcessor:
         //str << "db/Oct";
         stringArray.add(str);
     }
+    stringArray.add("72");
+    stringArray.add("96");
     
     layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LowCutSlope", 1}, "LowCutSlope", stringArray, 1));
     
@@ -247,36 +464,855 @@ juce::AudioProcessorValueTreeState::ParameterLayout SqueezeFilterAudioProcessor:
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"OffsetValue", 1},
                                                               "OffsetValue",
                                                               juce::NormalisableRange<float>(-19980.f, 19980.f,0.01), 0.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"StereoMode", 1}, "StereoMode", getStereoModeNames(), 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SideSqueeze", 1},
+                                                           "SideSqueeze",
+                                                           juce::NormalisableRange<float>(0.0001f, 1.0f), 1.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SideOffset", 1},
+                                                           "SideOffset",
+                                                           juce::NormalisableRange<float>(-19980.f, 19980.f, 0.01f), 0.0f));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"MorphEnabled", 1}, "MorphEnabled", false));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"MorphPosition", 1},
+                                                           "MorphPosition",
+                                                           juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Bypass", 1}, "Bypass", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"ParallelChannels", 1}, "ParallelChannels", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"ResponseType", 1}, "ResponseType", getResponseTypeNames(), 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"TargetAttenuation", 1},
+                                                           "TargetAttenuation",
+                                                           juce::NormalisableRange<float>(12.0f, 120.0f, 1.0f), 60.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"TargetDistance", 1},
+                                                           "TargetDistance",
+                                                           juce::NormalisableRange<float>(0.1f, 2.0f, 0.01f), 0.5f));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LfoRate", 1}, "LfoRate", getLfoRateNames(), 2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LfoShape", 1}, "LfoShape", getLfoShapeNames(), 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"LfoSqueezeDepth", 1},
+                                                           "LfoSqueezeDepth",
+                                                           juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"LfoOffsetDepth", 1},
+                                                           "LfoOffsetDepth",
+                                                           juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SidechainDepth", 1},
+                                                           "SidechainDepth",
+                                                           juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SidechainThreshold", 1},
+                                                           "SidechainThreshold",
+                                                           juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -30.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SidechainAttack", 1},
+                                                           "SidechainAttack",
+                                                           juce::NormalisableRange<float>(0.1f, 200.0f, 0.1f, 0.4f), 10.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"SidechainRelease", 1},
+                                                           "SidechainRelease",
+                                                           juce::NormalisableRange<float>(5.0f, 2000.0f, 1.0f, 0.4f), 150.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"SidechainMode", 1}, "SidechainMode", getEnvelopeModeNames(), 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"BandCount", 1}, "BandCount", getBandCountNames(), 0));
+    
+    const float crossoverDefaults[] { 120.0f, 800.0f, 3000.0f, 8000.0f };
+    for(int i = 0; i < maxBands - 1; ++i)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{getCrossoverId(i), 1},
+                                                               getCrossoverId(i),
+                                                               juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), crossoverDefaults[i]));
+    }
+    for(int band = 0; band < maxBands; ++band)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{getBandSqueezeId(band), 1},
+                                                               getBandSqueezeId(band),
+                                                               juce::NormalisableRange<float>(0.0001f, 1.0f), 1.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{getBandOffsetId(band), 1},
+                                                               getBandOffsetId(band),
+                                                               juce::NormalisableRange<float>(-19980.f, 19980.f, 0.01f), 0.0f));
+    }
 //    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"AnalyzerEnabled",1}, "AnalyzerEnabled", false));
     return layout;
 }
 
-void SqueezeFilterAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+static double getRingOutSamples(const CutSections& sections, int numSections)
+{
+    // Summed, which errs long for a cascade but never cuts a tail short
+    double total = 0.0;
+    for(int k = 0; k < numSections; ++k)
+        total += getRingOutSamples(sections[(size_t) k]);
+    return total;
+}
+
+void SqueezeFilterAudioProcessor::processFadingPath(juce::dsp::AudioBlock<float>& block)
+{
+    switch(fadingKind)
+    {
+        case PathKind::Channel:
+            (fadingFromCopy ? fadingCascade : channelCascade).process(block);
+            break;
+            
+        case PathKind::Pipeline:
+        {
+            auto& cascades = fadingFromCopy ? fadingPipelines : pipelinedCascades;
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            for(size_t ch = 0; ch < block.getNumChannels(); ++ch)
+                cascades[ch].process(block.getChannelPointer(ch), numSamples);
+            break;
+        }
+            
+        case PathKind::Multiband:
+            (fadingFromCopy ? fadingMultiband : multiband).process(block);
+            break;
+    }
+}
+
+void SqueezeFilterAudioProcessor::pushInputHistory(const juce::AudioBuffer<float>& mainBuffer, int startSample, int numSamples)
+{
+    const auto length = inputHistory.getNumSamples();
+    if(length == 0)
+        return;
+    
+    // Only the newest samples fit, written round the ring from historyPosition
+    const auto numToKeep = juce::jmin(numSamples, length);
+    startSample += numSamples - numToKeep;
+    const auto first = juce::jmin(numToKeep, length - historyPosition);
+    for(int ch = 0; ch < mainBuffer.getNumChannels(); ++ch)
+    {
+        inputHistory.copyFrom(ch, historyPosition, mainBuffer, ch, startSample, first);
+        if(numToKeep > first)
+            inputHistory.copyFrom(ch, 0, mainBuffer, ch, startSample + first, numToKeep - first);
+    }
+    historyPosition = (historyPosition + numToKeep) % length;
+}
+
+void SqueezeFilterAudioProcessor::prewarmPath()
+{
+    // fadeBuffer is free until the fade copies this tile in. Oldest first, the output is thrown away.
+    const auto length = inputHistory.getNumSamples();
+    for(int ch = 0; ch < inputHistory.getNumChannels(); ++ch)
+    {
+        fadeBuffer.copyFrom(ch, 0, inputHistory, ch, historyPosition, length - historyPosition);
+        fadeBuffer.copyFrom(ch, length - historyPosition, inputHistory, ch, 0, historyPosition);
+    }
+    
+    juce::dsp::AudioBlock<float> block(fadeBuffer);
+    processChains(block);
+}
+
+void SqueezeFilterAudioProcessor::setPathLayout(const PathLayout& layout, bool forceFade)
+{
+    if(hasPathLayout && layout == pathLayout && ! forceFade)
+        return;
+    
+    diagnostics.log(LogEvent::PathChanged, forceFade ? 1.0f : 0.0f, 0.0f, static_cast<int>(layout.kind));
+    
+    if(hasPathLayout && fadeLength > 0)
+    {
+        // A path that stays in use keeps running as a copy, one being left behind runs as it is
+        fadingKind = pathLayout.kind;
+        fadingFromCopy = layout.kind == pathLayout.kind;
+        if(fadingFromCopy && fadingKind == PathKind::Channel)
+            fadingCascade = channelCascade;
+        else if(fadingFromCopy && fadingKind == PathKind::Pipeline)
+            fadingPipelines = pipelinedCascades;
+        else if(fadingFromCopy && fadingKind == PathKind::Multiband)
+            fadingMultiband = multiband;
+        
+        fadeRemaining = fadeLength;
+        prewarmPending = true;
+    }
+    
+    // The new path starts from silence and is run over inputHistory before the next tile
+    switch(layout.kind)
+    {
+        case PathKind::Channel:
+            channelCascade.reset();
+            channelCascade.setMidSide(layout.midSide);
+            break;
+        case PathKind::Pipeline:
+            for(auto& cascade : pipelinedCascades)
+                cascade.reset();
+            break;
+        case PathKind::Multiband:
+            multiband.reset();
+            break;
+    }
+    
+    pathLayout = layout;
+    hasPathLayout = true;
+}
+
+void SqueezeFilterAudioProcessor::updateFilters(const ChainModulation& modulation, const ChainModulation& ramp)
+{
+    SQUEEZE_TRACE_SCOPE("updateFilters");
+    
+    // Bands and the side channel have their own squeeze and offset, only the cutoffs ramp there
+    ChainModulation cutoffRamp;
+    cutoffRamp.lowCut = ramp.lowCut;
+    cutoffRamp.highCut = ramp.highCut;
+    
+    if(multibandActive)
+    {
+        auto settings = getMultibandSettings(apvts, lastBandLowCuts, lastBandHighCuts, modulation + cutoffRamp);
+        setPathLayout({ PathKind::Multiband, false, { settings.numBands, 0, 0, 0 }, ResponseType::Butterworth,
+                        settings.bands[0].lowCutSlope, settings.bands[0].highCutSlope },
+                      std::exchange(recallArrived, false));
+        countRedesignIfChanged(settings);
+        multiband.update(settings);
+        tailSamples.store(multiband.getTailSamples());
+        // Multiband never runs on the pipeline, any latency it was reporting goes with it
+        usePipeline = false;
+        setPipelineLatency(0);
+        return;
+    }
+    
+    // Until the parameters have caught up with a recall, it stands in for them. Morphing
+    // replaces the main chain's knobs with the snapshots.
+    const auto* morphGrid = getMorphGrid();
+    const auto precomputed = morphGrid == nullptr && usePrecomputedRecall(modulation, ramp);
+    const auto morphPosition = apvts.getRawParameterValue("MorphPosition")->load() + modulation.morph + ramp.morph;
+    
+    ChainSettings chainSettings;
+    if(precomputed)
+        chainSettings = recall.settings;
+    else if(morphGrid != nullptr)
+        chainSettings = morphGrid->getSettings(morphPosition);
+    else
+        chainSettings = makeChainSettings(recallPending ? recall.parameters : getChainParameters(apvts),
+                                          lastLowCutParam, lastHighCutParam, modulation + ramp);
+    logChainSettings(chainSettings, 0);
+    auto spec = getDesignSpec(chainSettings);
+    const CutDesignTable* table = nullptr;
+    if(spec.type != ResponseType::Butterworth)
+        table = isNonRealtime() ? designCache.waitForTable(spec) : designCache.getTable(spec);
+    
+    // Bypass keeps the path, and so the latency, but runs no sections on it
+    CutSections lowCut, highCut, sideLowCut, sideHighCut;
+    int numLowCut = 0, numHighCut = 0, numSideLowCut = 0, numSideHighCut = 0;
+    if(! bypassActive && precomputed)
+    {
+        lowCut = recall.lowCut;
+        highCut = recall.highCut;
+        sideLowCut = recall.sideLowCut;
+        sideHighCut = recall.sideHighCut;
+        numLowCut = recall.numLowCut;
+        numHighCut = recall.numHighCut;
+        numSideLowCut = recall.numSideLowCut;
+        numSideHighCut = recall.numSideHighCut;
+    }
+    else if(! bypassActive)
+    {
+        if(morphGrid != nullptr)
+            morphGrid->lookup(morphPosition, lowCut, numLowCut, highCut, numHighCut);
+        else
+        {
+            numLowCut = designCascadeCut(lowCut, table, true, chainSettings);
+            numHighCut = designCascadeCut(highCut, table, false, chainSettings);
+        }
+        
+        if(midSideActive)
+        {
+            auto sideSettings = makeChainSettings(recallPending ? recall.sideParameters : getSideChainParameters(apvts),
+                                                  lastSideLowCutParam, lastSideHighCutParam, modulation + cutoffRamp);
+            logChainSettings(sideSettings, 1);
+            numSideLowCut = designCascadeCut(sideLowCut, table, true, sideSettings);
+            numSideHighCut = designCascadeCut(sideHighCut, table, false, sideSettings);
+        }
+    }
+    logRedesign(chainSettings, numLowCut + numHighCut + numSideLowCut + numSideHighCut);
+    countRedesignIfChanged({ &lowCut, &highCut, &sideLowCut, &sideHighCut }, { numLowCut, numHighCut, numSideLowCut, numSideHighCut });
+    auto ringOut = juce::jmax(getRingOutSamples(lowCut, numLowCut) + getRingOutSamples(highCut, numHighCut),
+                              getRingOutSamples(sideLowCut, numSideLowCut) + getRingOutSamples(sideHighCut, numSideHighCut));
+    
+    // Deep cascades on one or two channels would leave most of each channel group's lanes
+    // empty, so they run on the pipelined cascade instead and pay for it with latency.
+    // Mid/side stays on the channel kernel, which folds the encode and decode into its tiles.
+    usePipeline = usesCascade(chainSettings) && ! midSideActive
+               && channelCascade.getNumChannels() <= pipelinedCascades.size();
+    
+    // A recall starts its sections from silence and fades in like a path change, even on the same path
+    setPathLayout({ usePipeline ? PathKind::Pipeline : PathKind::Channel, midSideActive,
+                    { numLowCut, numHighCut, numSideLowCut, numSideHighCut },
+                    spec.type, chainSettings.lowCutSlope, chainSettings.highCutSlope },
+                  std::exchange(recallArrived, false));
+    
+    if(usePipeline)
+    {
+        for(auto& cascade : pipelinedCascades)
+        {
+            size_t section = 0;
+            for(int k = 0; k < numLowCut; ++k)
+                cascade.setSection(section++, lowCut[(size_t) k]);
+            for(int k = 0; k < numHighCut; ++k)
+                cascade.setSection(section++, highCut[(size_t) k]);
+            
+            // Fixed depth, so the latency only changes when the pipeline is switched on or off
+            while(section < cascade.numLanes)
+                cascade.setSection(section++, identitySection);
+        }
+        setPipelineLatency(pipelinedCascades[0].getLatency());
+        tailSamples.store(static_cast<int>(std::ceil(ringOut)) + pipelinedCascades[0].getLatency());
+        return;
+    }
+    
+    if(midSideActive)
+    {
+        // Table designs can differ in order across the range, the shorter lane is padded out
+        const auto numSections = (size_t) juce::jmax(numLowCut + numHighCut, numSideLowCut + numSideHighCut);
+        setCascadeSections(0, lowCut, numLowCut, highCut, numHighCut, numSections);
+        setCascadeSections(1, sideLowCut, numSideLowCut, sideHighCut, numSideHighCut, numSections);
+        channelCascade.setNumSections(numSections);
+    }
+    else
+    {
+        const auto numSections = (size_t) (numLowCut + numHighCut);
+        setCascadeSections(-1, lowCut, numLowCut, highCut, numHighCut, numSections);
+        channelCascade.setNumSections(numSections);
+    }
+    
+    setPipelineLatency(0);
+    tailSamples.store(static_cast<int>(std::ceil(ringOut)));
+}
+
+// channel < 0 writes the same sections to every channel
+void SqueezeFilterAudioProcessor::setCascadeSections(int channel, const CutSections& lowCut, int numLowCut,
+                                                     const CutSections& highCut, int numHighCut, size_t numSections)
+{
+    auto setSection = [this, channel](size_t section, const BiquadCoefficients& c)
+    {
+        if(channel < 0)
+            channelCascade.setSection(section, c);
+        else
+            channelCascade.setSection(section, static_cast<size_t>(channel), c);
+    };
+    
+    size_t section = 0;
+    for(int k = 0; k < numLowCut; ++k)
+        setSection(section++, lowCut[(size_t) k]);
+    for(int k = 0; k < numHighCut; ++k)
+        setSection(section++, highCut[(size_t) k]);
+    while(section < numSections)
+        setSection(section++, identitySection);
+}
+
+DesignSpec SqueezeFilterAudioProcessor::getDesignSpec(const ChainSettings& chainSettings) const
+{
+    // Fields the type ignores stay at their defaults, so turning those knobs keeps the cached table
+    DesignSpec spec;
+    spec.type = static_cast<ResponseType>(apvts.getRawParameterValue("ResponseType")->load());
+    spec.sampleRate = getSampleRate();
+    if(spec.type == ResponseType::AutoTarget)
+    {
+        spec.targetAttenuation = apvts.getRawParameterValue("TargetAttenuation")->load();
+        spec.targetDistance = apvts.getRawParameterValue("TargetDistance")->load();
+    }
+    else
+    {
+        spec.lowCutSlope = chainSettings.lowCutSlope;
+        spec.highCutSlope = chainSettings.highCutSlope;
+    }
+    return spec;
+}
+
+bool SqueezeFilterAudioProcessor::usesCascade(const ChainSettings& chainSettings) const
+{
+    return isSteep(chainSettings.lowCutSlope) || isSteep(chainSettings.highCutSlope)
+        || static_cast<ResponseType>(apvts.getRawParameterValue("ResponseType")->load()) != ResponseType::Butterworth;
+}
+
+int SqueezeFilterAudioProcessor::designCascadeCut(CutSections& sections, const CutDesignTable* table, bool isHighPass, const ChainSettings& chainSettings)
+{
+    const auto frequency = isHighPass ? chainSettings.lowCutFreq : chainSettings.highCutFreq;
+    
+    // Butterworth, or the fallback until the background thread has the table for this spec
+    if(table != nullptr)
+        return table->lookup(sections, isHighPass, frequency);
+    
+    return designButterworthCut(sections, isHighPass, frequency, isHighPass ? chainSettings.lowCutSlope : chainSettings.highCutSlope);
+}
+
+int SqueezeFilterAudioProcessor::designButterworthCut(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept
+{
+    // An interpolated lookup, a tan and a log instead of a tan and a cos per section
+    if(cutTables != nullptr)
+        return cutTables->lookup(sections, isHighPass, frequency, slope);
+    return designCutSections(sections, isHighPass, frequency, getSampleRate(), slope);
+}
+
+void SqueezeFilterAudioProcessor::setPipelineLatency(int samples)
+{
+    // Hosts expect latency changes from the message thread
+    if(pipelineLatency.exchange(samples) != samples)
+        triggerAsyncUpdate();
+}
+
+void SqueezeFilterAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(pipelineLatency.load());
+    
+    if(morphGridStale.exchange(false))
+        rebuildMorphGrid();
+}
+
+bool SqueezeFilterAudioProcessor::isModulated() const
+{
+    return apvts.getRawParameterValue("LfoSqueezeDepth")->load() > 0.0f
+        || apvts.getRawParameterValue("LfoOffsetDepth")->load() > 0.0f
+        || isSidechainActive();
+}
+
+bool SqueezeFilterAudioProcessor::isSidechainActive() const
+{
+    auto* sidechain = getBus(true, 1);
+    return sidechain != nullptr && sidechain->isEnabled()
+        && apvts.getRawParameterValue("SidechainDepth")->load() != 0.0f;
+}
+
+ChainModulation SqueezeFilterAudioProcessor::getNextModulation(const juce::AudioBuffer<float>& sidechain, int startSample, int numSamples)
+{
+    auto lfoValue = lfo.getNextValue(numSamples);
+    
+    ChainModulation modulation;
+    modulation.squeeze = lfoValue * apvts.getRawParameterValue("LfoSqueezeDepth")->load();
+    modulation.offset = lfoValue * apvts.getRawParameterValue("LfoOffsetDepth")->load() * 19980.0f;
+    
+    if(sidechain.getNumChannels() > 0)
+    {
+        // Full depth is reached 24 dB above the threshold
+        auto levelDb = sidechainFollower.process(sidechain, startSample, numSamples);
+        auto threshold = apvts.getRawParameterValue("SidechainThreshold")->load();
+        auto amount = juce::jlimit(0.0f, 1.0f, (levelDb - threshold) / 24.0f);
+        modulation.squeeze -= amount * apvts.getRawParameterValue("SidechainDepth")->load();
+    }
+    return modulation;
+}
+
+std::array<float, 5> SqueezeFilterAudioProcessor::getHostValues() const
+{
+    return { apvts.getRawParameterValue("hp")->load(),
+             apvts.getRawParameterValue("lp")->load(),
+             apvts.getRawParameterValue("SqueezeValue")->load(),
+             apvts.getRawParameterValue("OffsetValue")->load(),
+             apvts.getRawParameterValue("MorphPosition")->load() };
+}
+
+ChainModulation SqueezeFilterAudioProcessor::getParameterRamp()
+{
+    // Added to the new values this lands on the old ones, and shrinks to zero over the block
+    const auto previous = std::exchange(lastHostValues, getHostValues());
+    
+    ChainModulation ramp;
+    ramp.lowCut = previous[0] - lastHostValues[0];
+    ramp.highCut = previous[1] - lastHostValues[1];
+    ramp.squeeze = previous[2] - lastHostValues[2];
+    ramp.offset = previous[3] - lastHostValues[3];
+    ramp.morph = previous[4] - lastHostValues[4];
+    return ramp;
+}
+
+void SqueezeFilterAudioProcessor::logChainSettings(const ChainSettings& chainSettings, int chain)
+{
+    // Once when the clamp starts holding, not for every block the knobs stay crossed
+    if(chainSettings.cutoffsClamped && ! clampLogged[(size_t) chain])
+        diagnostics.log(LogEvent::CutoffClamp, chainSettings.lowCutFreq, chainSettings.highCutFreq, chain);
+    clampLogged[(size_t) chain] = chainSettings.cutoffsClamped;
+}
+
+void SqueezeFilterAudioProcessor::logRedesign(const ChainSettings& chainSettings, int numSections)
+{
+    // Cutoff moves under 1% are left out, modulation would log every sub-block otherwise
+    auto moved = [](float from, float to) { return std::abs(to - from) > 0.01f * from; };
+    
+    if(numSections == lastLoggedSections
+       && chainSettings.lowCutSlope == lastLoggedSettings.lowCutSlope
+       && chainSettings.highCutSlope == lastLoggedSettings.highCutSlope
+       && ! moved(lastLoggedSettings.lowCutFreq, chainSettings.lowCutFreq)
+       && ! moved(lastLoggedSettings.highCutFreq, chainSettings.highCutFreq))
+        return;
+    
+    diagnostics.log(LogEvent::Redesigned, chainSettings.lowCutFreq, chainSettings.highCutFreq, numSections);
+    lastLoggedSettings = chainSettings;
+    lastLoggedSections = numSections;
+}
+
+void SqueezeFilterAudioProcessor::countRedesignIfChanged(const std::array<const CutSections*, 4>& sections, const std::array<int, 4>& counts)
+{
+    auto sameSection = [](const BiquadCoefficients& a, const BiquadCoefficients& b)
+    {
+        return a.b0 == b.b0 && a.b1 == b.b1 && a.b2 == b.b2 && a.a1 == b.a1 && a.a2 == b.a2;
+    };
+    
+    auto changed = counts != lastDesignCounts;
+    for(size_t cut = 0; cut < sections.size() && ! changed; ++cut)
+        changed = ! std::equal(sections[cut]->begin(), sections[cut]->begin() + counts[cut],
+                               lastDesignSections[cut].begin(), sameSection);
+    if(! changed)
+        return;
+    
+    telemetry.countRedesign();
+    for(size_t cut = 0; cut < sections.size(); ++cut)
+        lastDesignSections[cut] = *sections[cut];
+    lastDesignCounts = counts;
+    lastDesignBands.numBands = 0;
+}
+
+void SqueezeFilterAudioProcessor::countRedesignIfChanged(const MultibandSettings& settings)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    // Every lane's coefficients follow from these, so they stand in for comparing the lanes
+    auto sameBand = [](const ChainSettings& a, const ChainSettings& b)
+    {
+        return a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+            && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope;
+    };
     
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+    const auto numBands = static_cast<size_t>(settings.numBands);
+    if(settings.numBands == lastDesignBands.numBands
+       && std::equal(settings.crossoverFreqs.begin(), settings.crossoverFreqs.begin() + (numBands - 1),
+                     lastDesignBands.crossoverFreqs.begin())
+       && std::equal(settings.bands.begin(), settings.bands.begin() + numBands, lastDesignBands.bands.begin(), sameBand))
+        return;
     
+    telemetry.countRedesign();
+    lastDesignBands = settings;
+    lastDesignCounts.fill(-1);
 }
 
-void SqueezeFilterAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+void SqueezeFilterAudioProcessor::logAnalyzerOverflows()
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    // Logged as the fifos fill up, which is every block while the editor is closed
+    const auto overflows = leftChannelFifo.getNumOverflows() + rightChannelFifo.getNumOverflows();
+    if(overflows != lastAnalyzerOverflows && ! analyzerOverflowing)
+        diagnostics.log(LogEvent::AnalyzerFifoFull, 0.0f, 0.0f, static_cast<int>(overflows));
+    analyzerOverflowing = overflows != lastAnalyzerOverflows;
+    lastAnalyzerOverflows = overflows;
 }
 
-void SqueezeFilterAudioProcessor::updateFilters()
+int SqueezeFilterAudioProcessor::getAnalyzerFFTOrder() const
 {
-    auto chainSettings = getChainSettings(apvts,lastLowCutParam,lastHighCutParam);
+    return AnalyzerBudget::chooseOrder(analyzerBudgetBytes.load(), getSampleRate());
+}
+
+size_t SqueezeFilterAudioProcessor::getAnalyzerMemoryBytes() const
+{
+    return leftChannelFifo.getMemoryBytes() + rightChannelFifo.getMemoryBytes() + editorAnalyzerBytes.load();
+}
 
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
+juce::String SqueezeFilterAudioProcessor::getAnalyzerMemoryReport() const
+{
+    auto kb = [](size_t bytes) { return juce::String(static_cast<double>(bytes) / 1024.0, 1) + " KB"; };
+    const auto editorBytes = editorAnalyzerBytes.load();
+    
+    juce::String report;
+    report << "analyzer " << kb(getAnalyzerMemoryBytes()) << " of " << kb(analyzerBudgetBytes.load())
+           << ": sample fifos " << kb(leftChannelFifo.getMemoryBytes() + rightChannelFifo.getMemoryBytes())
+           << ", editor " << (editorBytes > 0 ? kb(editorBytes) + " (" + juce::String(editorFFTSize.load()) + " point FFT)"
+                                              : juce::String("closed"));
+    return report;
+}
+
+bool SqueezeFilterAudioProcessor::skipSilence(juce::AudioBuffer<float>& mainBuffer)
+{
+    const auto numSamples = mainBuffer.getNumSamples();
+    
+    for(int ch = 0; ch < mainBuffer.getNumChannels(); ++ch)
+    {
+        if(mainBuffer.getMagnitude(ch, 0, numSamples) >= silenceThreshold)
+        {
+            silentSamples = 0;
+            filtersAsleep = false;
+            return false;
+        }
+    }
+    
+    // Everything heard since the input went quiet has to have rung out first
+    const auto hasDecayed = silentSamples >= tailSamples.load();
+    silentSamples = juce::jmin(silentSamples + numSamples, std::numeric_limits<int>::max() / 2);
+    if(! hasDecayed)
+        return false;
+    
+    // The states are below the threshold anyway, clearing them makes the restart exact
+    if(! filtersAsleep)
+    {
+        channelCascade.reset();
+        for(auto& cascade : pipelinedCascades)
+            cascade.reset();
+        multiband.reset();
+        inputHistory.clear();
+        filtersAsleep = true;
+    }
+    
+    // Keeps a knob move made during the silence from ramping in from a stale value
+    lastHostValues = getHostValues();
+    mainBuffer.clear();
+    return true;
+}
+
+bool SqueezeFilterAudioProcessor::isBypassed() const
+{
+    return apvts.getRawParameterValue("Bypass")->load() > 0.5f;
+}
+
+bool SqueezeFilterAudioProcessor::isMultiband() const
+{
+    return apvts.getRawParameterValue("BandCount")->load() > 0.0f;
+}
+
+bool SqueezeFilterAudioProcessor::isMidSide() const
+{
+    return channelCascade.getNumChannels() == 2
+        && static_cast<StereoMode>(apvts.getRawParameterValue("StereoMode")->load()) == StereoMode::MidSide;
+}
+
+bool SqueezeFilterAudioProcessor::openPresetBank(const juce::File& file)
+{
+    presetBankFile = file;
+    return PresetBank::use(file, [](const PresetBank&) {});
+}
+
+bool SqueezeFilterAudioProcessor::usePresetBank(const std::function<void(const PresetBank&)>& reader) const
+{
+    return PresetBank::use(presetBankFile, reader);
+}
+
+bool SqueezeFilterAudioProcessor::recallPreset(int index)
+{
+    // Read before recalling, the bank is unmapped again by the time the parameters are set
+    std::optional<ChainParameters> preset;
+    usePresetBank([&preset, index](const PresetBank& bank)
+    {
+        if(juce::isPositiveAndBelow(index, bank.getNumPresets()))
+            preset = bank.getParameters(index);
+    });
+    
+    if(! preset.has_value())
+        return false;
+    
+    recallPreset(*preset);
+    return true;
+}
+
+void SqueezeFilterAudioProcessor::recallPreset(const ChainParameters& preset)
+{
+    // Snapped to what the parameters can hold, so the audio thread designs the same thing
+    // from them once they are set
+    auto snap = [this](const char* id, float value)
+    {
+        auto* parameter = apvts.getParameter(id);
+        return parameter->convertFrom0to1(parameter->convertTo0to1(value));
+    };
+    
+    PresetRecall next;
+    next.parameters = preset;
+    next.parameters.lowCut = snap("hp", preset.lowCut);
+    next.parameters.highCut = snap("lp", preset.highCut);
+    next.parameters.squeeze = snap("SqueezeValue", preset.squeeze);
+    next.parameters.offset = snap("OffsetValue", preset.offset);
+    
+    next.sideParameters = getSideChainParameters(apvts);
+    next.sideParameters.lowCut = next.parameters.lowCut;
+    next.sideParameters.highCut = next.parameters.highCut;
+    next.sideParameters.lowCutSlope = next.parameters.lowCutSlope;
+    next.sideParameters.highCutSlope = next.parameters.highCutSlope;
+    next.midSide = isMidSide();
+    next.generation = ++recallGeneration;
+    
+    next.settings = makeChainSettings(next.parameters, next.lastLowCut, next.lastHighCut);
+    next.spec = getDesignSpec(next.settings);
+    next.designed = next.spec.type == ResponseType::Butterworth && next.spec.sampleRate > 0.0;
+    if(next.designed)
+    {
+        // The same lookups the audio thread makes, so nothing moves once the parameters take over
+        auto& settings = next.settings;
+        next.numLowCut = designButterworthCut(next.lowCut, true, settings.lowCutFreq, settings.lowCutSlope);
+        next.numHighCut = designButterworthCut(next.highCut, false, settings.highCutFreq, settings.highCutSlope);
+        
+        if(next.midSide)
+        {
+            auto sideSettings = makeChainSettings(next.sideParameters, next.lastSideLowCut, next.lastSideHighCut);
+            next.numSideLowCut = designButterworthCut(next.sideLowCut, true, sideSettings.lowCutFreq, sideSettings.lowCutSlope);
+            next.numSideHighCut = designButterworthCut(next.sideHighCut, false, sideSettings.highCutFreq, sideSettings.highCutSlope);
+        }
+    }
+    
+    // With the queue full the parameters alone still get there, a block at a time
+    {
+        auto write = recallFifo.write(1);
+        if(write.blockSize1 > 0)
+            recalls[(size_t) write.startIndex1] = next;
+    }
+    
+    auto set = [this](const char* id, float value)
+    {
+        auto* parameter = apvts.getParameter(id);
+        parameter->beginChangeGesture();
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        parameter->endChangeGesture();
+    };
+    set("hp", next.parameters.lowCut);
+    set("lp", next.parameters.highCut);
+    set("SqueezeValue", next.parameters.squeeze);
+    set("OffsetValue", next.parameters.offset);
+    set("LowCutSlope", static_cast<float>(next.parameters.lowCutSlope));
+    set("HighCutSlope", static_cast<float>(next.parameters.highCutSlope));
+    
+    recallsApplied.store(next.generation);
+}
+
+bool SqueezeFilterAudioProcessor::saveCurrentAsPreset(const juce::String& name)
+{
+    // Other instances see the new bank the next time they read it
+    return PresetBank::save(presetBankFile, { name, getChainParameters(apvts) });
+}
+
+void SqueezeFilterAudioProcessor::pickUpRecall()
+{
+    // Checked before taking a new one, so a recall always runs for at least one block
+    if(recallPending && recallsApplied.load() >= recall.generation)
+    {
+        // Every parameter holds the preset now and designs the same sections from here on
+        recallPending = false;
+        lastHostValues = getHostValues();
+    }
+    
+    // Only the latest counts when several arrive between blocks
+    for(;;)
+    {
+        auto read = recallFifo.read(1);
+        if(read.blockSize1 == 0)
+            break;
+        
+        recall = recalls[(size_t) read.startIndex1];
+        recallPending = true;
+        recallArrived = true;
+    }
+    
+    if(recallArrived)
+    {
+        lastLowCutParam = recall.lastLowCut;
+        lastHighCutParam = recall.lastHighCut;
+        lastSideLowCutParam = recall.lastSideLowCut;
+        lastSideHighCutParam = recall.lastSideHighCut;
+    }
+}
+
+bool SqueezeFilterAudioProcessor::usePrecomputedRecall(const ChainModulation& modulation, const ChainModulation& ramp) const
+{
+    return recallPending && recall.designed && modulation.isZero() && ramp.isZero()
+        && recall.midSide == midSideActive && getDesignSpec(recall.settings) == recall.spec;
+}
+
+bool SqueezeFilterAudioProcessor::storeMorphSnapshot(int index)
+{
+    // The clamp memory is the audio thread's, the capture works on a copy of it
+    auto lastLowCut = lastLowCutParam, lastHighCut = lastHighCutParam;
+    const auto settings = getChainSettings(apvts, lastLowCut, lastHighCut);
+    
+    {
+        const juce::ScopedLock sl(morphLock);
+        if(! juce::isPositiveAndBelow(index, juce::jmin(static_cast<int>(morphSnapshots.size()) + 1, MorphGrid::maxSnapshots)))
+            return false;
+        
+        if(index == static_cast<int>(morphSnapshots.size()))
+            morphSnapshots.push_back(settings);
+        else
+            morphSnapshots[(size_t) index] = settings;
+    }
+    
+    requestMorphGridRebuild();
+    return true;
+}
+
+void SqueezeFilterAudioProcessor::clearMorphSnapshots()
+{
+    {
+        const juce::ScopedLock sl(morphLock);
+        morphSnapshots.clear();
+    }
+    requestMorphGridRebuild();
+}
+
+void SqueezeFilterAudioProcessor::rebuildMorphGrid()
+{
+    std::vector<ChainSettings> snapshots;
+    {
+        const juce::ScopedLock sl(morphLock);
+        snapshots = morphSnapshots;
+    }
+    
+    auto& grid = morphGrids.getWriteBuffer();
+    grid.build(snapshots, getDesignSpec({}));
+    morphGrids.publish();
+}
+
+void SqueezeFilterAudioProcessor::requestMorphGridRebuild()
+{
+    // prepareToPlay and setStateInformation can come from any thread, the grid has one writer
+    if(juce::MessageManager::existsAndIsCurrentThread())
+        rebuildMorphGrid();
+    else if(! morphGridStale.exchange(true))
+        triggerAsyncUpdate();
+}
+
+const MorphGrid* SqueezeFilterAudioProcessor::getMorphGrid()
+{
+    if(apvts.getRawParameterValue("MorphEnabled")->load() < 0.5f)
+        return nullptr;
+    
+    auto* grid = morphGrids.read();
+    if(grid == nullptr || grid->getNumSnapshots() < 2)
+        return nullptr;
+    
+    // A new response type or rate needs new designs, until then the knobs play as usual
+    if(! grid->matches(getDesignSpec({})))
+    {
+        if(! morphGridStale.exchange(true))
+            triggerAsyncUpdate();
+        return nullptr;
+    }
+    return grid;
+}
+
+juce::MemoryBlock SqueezeFilterAudioProcessor::getMorphState() const
+{
+    const juce::ScopedLock sl(morphLock);
+    juce::MemoryBlock data;
+    if(morphSnapshots.empty())
+        return data;
+    
+    juce::MemoryOutputStream mos(data, false);
+    mos.writeByte(static_cast<char>(morphSnapshots.size()));
+    for(auto& snapshot : morphSnapshots)
+    {
+        mos.writeFloat(snapshot.lowCutFreq);
+        mos.writeFloat(snapshot.highCutFreq);
+        mos.writeByte(static_cast<char>(snapshot.lowCutSlope));
+        mos.writeByte(static_cast<char>(snapshot.highCutSlope));
+    }
+    mos.flush();
+    return data;
+}
+
+void SqueezeFilterAudioProcessor::setMorphState(const juce::MemoryBlock& data)
+{
+    std::vector<ChainSettings> snapshots;
+    
+    juce::MemoryInputStream mis(data, false);
+    const auto count = juce::jmin(static_cast<int>(static_cast<juce::uint8>(mis.readByte())), MorphGrid::maxSnapshots);
+    for(int i = 0; i < count && mis.getNumBytesRemaining() >= 10; ++i)
+    {
+        ChainSettings snapshot;
+        snapshot.lowCutFreq = juce::jlimit(20.0f, 20000.0f, mis.readFloat());
+        snapshot.highCutFreq = juce::jlimit(20.0f, 20000.0f, mis.readFloat());
+        snapshot.lowCutSlope = static_cast<Slope>(juce::jlimit(0, static_cast<int>(Slope_96), static_cast<int>(mis.readByte())));
+        snapshot.highCutSlope = static_cast<Slope>(juce::jlimit(0, static_cast<int>(Slope_96), static_cast<int>(mis.readByte())));
+        snapshots.push_back(snapshot);
+    }
+    
+    {
+        const juce::ScopedLock sl(morphLock);
+        morphSnapshots = std::move(snapshots);
+    }
+    requestMorphGridRebuild();
 }
 
 //==============================================================================
@@ -11,6 +11,21 @@
 #include <JuceHeader.h>
 #include "Custom/Filter.h"
 #include "Custom/Fifo.h"
+#include "Custom/Lfo.h"
+#include "Custom/Envelope.h"
+#include "Custom/Multiband.h"
+#include "Custom/LaneFilter.h"
+#include "Custom/CutDesign.h"
+#include "Custom/ChannelWorkers.h"
+#include "Custom/StateFormat.h"
+#include "Custom/PresetBank.h"
+#include "Custom/Morph.h"
+#include "Custom/CutLookup.h"
+#include "Custom/Telemetry.h"
+#include "Custom/Trace.h"
+#include "Custom/DiagnosticLog.h"
+#include "Custom/Metering.h"
+#include "Custom/Loudness.h"
 
 //==============================================================================
 /**
@@ -19,6 +34,7 @@ class SqueezeFilterAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -34,6 +50,11 @@ public:
 #endif
     
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+   #if SQUEEZE_HAS_AUDIO_WORKGROUP
+    void audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup) override;
+   #endif
     
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -67,39 +88,281 @@ public:
     SingleChannelSampleFifo<BlockType> leftChannelFifo {Channel::Left};
     SingleChannelSampleFifo<BlockType> rightChannelFifo {Channel::Right};
     
-    // Save and set GUI resize
-    int getEditorWidth()
-    {
-        auto size = apvts.state.getOrCreateChildWithName ("lastSize", nullptr);
-        return size.getProperty ("width", 650);
-    }
-    int getEditorHeight()
-    {
-        const float ratio = 16.0/ 9.0;
-        auto size = apvts.state.getOrCreateChildWithName ("lastSize", nullptr);
-        return size.getProperty ("height", 650.0 / ratio);
-    }
+    // Save and set GUI resize, kept outside the parameter tree so the binary state can carry it
+    int getEditorWidth() const { return editorWidth; }
+    int getEditorHeight() const { return editorHeight; }
 
     void setEditorSize (int width, int height)
     {
-        auto size = apvts.state.getOrCreateChildWithName ("lastSize", nullptr);
-        size.setProperty ("width", width, nullptr);
-        size.setProperty ("height", height, nullptr);
+        editorWidth = width;
+        editorHeight = height;
     }
     
+    //PRESETS
+    // Message thread. A recall hands the audio thread the preset with its sections already
+    // designed, so it switches in one block rather than following each parameter as it changes.
+    // The bank file is only mapped while it is being read, see PresetBank
+    bool openPresetBank(const juce::File& file);
+    bool usePresetBank(const std::function<void(const PresetBank&)>& reader) const;
+    bool recallPreset(int index);
+    void recallPreset(const ChainParameters& preset);
+    // Adds the current settings to the bank, replacing a preset of the same name
+    bool saveCurrentAsPreset(const juce::String& name);
+    
+    //MORPH
+    // Message thread. Stores what the main chain plays now, through getChainSettings, as
+    // snapshot 'index'; the next free index adds one. MorphPosition sweeps across them in order.
+    bool storeMorphSnapshot(int index);
+    void clearMorphSnapshots();
+    int getNumMorphSnapshots() const
+    {
+        const juce::ScopedLock sl(morphLock);
+        return static_cast<int>(morphSnapshots.size());
+    }
+    
+    // For a processor driven without a message loop, as the renderer's are: runs the message
+    // thread work that is waiting (latency report, morph grid rebuild) on the calling thread.
+    // Only safe while no message thread can run it at the same time.
+    void runPendingMessageThreadWork() { handleUpdateNowIfNeeded(); }
+    
+    // How long the last setStateInformation() took, for session load profiling
+    double getLastStateLoadMicroseconds() const { return lastStateLoadMicroseconds.load(); }
+    
+    // Wide beds (up to 7.1.4, 3rd order ambisonics and beyond) run through the same kernel
+    static constexpr int maxChannels = 64;
+    
     double lastLowCutParam;
     double lastHighCutParam;
     
+    DesignSpec getDesignSpec(const ChainSettings& chainSettings) const;
+    
+    // Butterworth sections at the current rate, shared with every other instance at that rate
+    const CutLookupTables* getCutTables() const { return cutTables.get(); }
+    
+    // What the last block ran with, without waiting for the host to be told on the message thread
+    int getProcessingLatency() const { return pipelineLatency.load(); }
+    
+    // Editor only, reading takes the peaks held since the last read
+    std::array<MeterLevels, 2> readInputLevels() { return inputMeter.read(); }
+    std::array<MeterLevels, 2> readOutputLevels() { return outputMeter.read(); }
+    
+    // Any thread. Before and after the filters, so the difference is what the squeeze does to loudness.
+    LoudnessReading getInputLoudness() const { return inputLoudness.read(); }
+    LoudnessReading getOutputLoudness() const { return outputLoudness.read(); }
+    void resetIntegratedLoudness()
+    {
+        inputLoudness.resetIntegrated();
+        outputLoudness.resetIntegrated();
+    }
+    
+    // Any thread. Load against the block deadline since the last prepareToPlay, with the
+    // analyzer buffers both fifos have dropped.
+    TelemetrySnapshot getTelemetry() const
+    {
+        auto snapshot = telemetry.getSnapshot();
+        snapshot.numAnalyzerOverflows = leftChannelFifo.getNumOverflows() + rightChannelFifo.getNumOverflows();
+        return snapshot;
+    }
+    
+    //ANALYZER
+    // Message thread. The sample fifos are sized by the rate at prepareToPlay, what the budget
+    // leaves after them decides the FFT order of the next editor to open.
+    void setAnalyzerBudget(size_t bytes) { analyzerBudgetBytes.store(bytes); }
+    size_t getAnalyzerBudget() const { return analyzerBudgetBytes.load(); }
+    int getAnalyzerFFTOrder() const;
+    // The editor's path producers report what they hold when it opens, and zero when it closes
+    void setEditorAnalyzerUsage(size_t bytes, int fftSize)
+    {
+        editorAnalyzerBytes.store(bytes);
+        editorFFTSize.store(fftSize);
+    }
+    // Everything the analyzer holds for this instance, the open editor's share included
+    size_t getAnalyzerMemoryBytes() const;
+    juce::String getAnalyzerMemoryReport() const;
+    
 private:
-   
-    //STEREO
-    juce::LinearSmoothedValue<float> rmsLevelLeft, rmsLevelRight;
-    MonoChain leftChain, rightChain;
+
+    //STATE
+    BinaryState binaryState;
+    int editorWidth = 650;
+    int editorHeight = static_cast<int>(650.0 / (16.0 / 9.0));
+    std::atomic<double> lastStateLoadMicroseconds {0.0};
     
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //ANALYZER
+    std::atomic<size_t> analyzerBudgetBytes {AnalyzerBudget::defaultBytes};
+    std::atomic<size_t> editorAnalyzerBytes {0};
+    std::atomic<int> editorFFTSize {0};
+    
+    //TELEMETRY
+    DspTelemetry telemetry;
+    // What the last counted redesign came out as, an update that changes nothing isn't counted
+    std::array<CutSections, 4> lastDesignSections {};
+    std::array<int, 4> lastDesignCounts { -1, -1, -1, -1 };
+    MultibandSettings lastDesignBands;
+    void countRedesignIfChanged(const std::array<const CutSections*, 4>& sections, const std::array<int, 4>& counts);
+    void countRedesignIfChanged(const MultibandSettings& settings);
+    // Held so a trace started through SQUEEZE_TRACE runs for as long as any instance does
+    juce::SharedResourcePointer<Tracer> tracer;
+    
+    //DIAGNOSTICS
+    // Only what changed gets logged, a redesign per sub-block would fill the ring in no time
+    DiagnosticLog diagnostics;
+    ChainSettings lastLoggedSettings;
+    int lastLoggedSections = -1;
+    std::array<bool, 2> clampLogged {};
+    juce::uint64 lastAnalyzerOverflows = 0;
+    bool analyzerOverflowing = false;
+    void logChainSettings(const ChainSettings& chainSettings, int chain);
+    void logRedesign(const ChainSettings& chainSettings, int numSections);
+    void logAnalyzerOverflows();
 
-    void updateFilters();
+    //METERS
+    LevelMeter inputMeter, outputMeter;
+    LoudnessMeter inputLoudness, outputLoudness;
+    
+    // Every channel of the main bus, packed into SIMD lanes
+    ChannelCascade<maxChannels, 2 * maxCutSections> channelCascade;
+
+    // Redesigns every section in place, cheap enough to run per modulation sub-block. The ramp
+    // applies to hp/lp everywhere but to squeeze and offset only on the main (mid) chain.
+    void updateFilters(const ChainModulation& modulation = {}, const ChainModulation& ramp = {});
+    
+    //CASCADES (steep slopes and non Butterworth responses on mono/stereo)
+    std::array<PipelinedCascade<2 * maxCutSections>, 2> pipelinedCascades;
+    bool usePipeline = false;
+    std::atomic<int> pipelineLatency {0};
+    
+    CutDesignCache designCache;
+    std::shared_ptr<const CutLookupTables> cutTables;
+    int designButterworthCut(CutSections& sections, bool isHighPass, float frequency, Slope slope) const noexcept;
+    
+    bool usesCascade(const ChainSettings& chainSettings) const;
+    int designCascadeCut(CutSections& sections, const CutDesignTable* table, bool isHighPass, const ChainSettings& chainSettings);
+    void setPipelineLatency(int samples);
+    void handleAsyncUpdate() override;
+    
+    //MODULATION
+    // Coefficients follow the modulation at this many samples
+    static constexpr int modulationBlockSize = 32;
+    SqueezeLfo lfo;
+    EnvelopeFollower sidechainFollower;
+    
+    bool isModulated() const;
+    bool isSidechainActive() const;
+    ChainModulation getNextModulation(const juce::AudioBuffer<float>& sidechain, int startSample, int numSamples);
+    void processChains(juce::dsp::AudioBlock<float>& block);
+    // Filters a range of the main bus and hands it to the analyzer straight after
+    void processTile(juce::AudioBuffer<float>& mainBuffer, int startSample, int numSamples);
+    static constexpr int l1CacheBytes = 32 * 1024;
+    
+    //AUTOMATION
+    // JUCE hands over a single value per parameter per block, so a change is ramped in from the
+    // previous block's value on the modulation grid instead of stepping at the block start
+    std::array<float, 5> lastHostValues {};
+    std::array<float, 5> getHostValues() const;
+    ChainModulation getParameterRamp();
+    
+    //MULTIBAND
+    MultibandSqueeze multiband;
+    std::array<double, maxBands> lastBandLowCuts {}, lastBandHighCuts {};
+    // Read once per block so the update and the process always agree
+    bool multibandActive = false;
+    bool isMultiband() const;
+    
+    //PARALLEL CHANNELS
+    // Below this many channels handing groups to other threads costs more than it saves
+    static constexpr int parallelChannelThreshold = 16;
+    ChannelWorkers channelWorkers;
+    bool parallelActive = false;
+    
+    //SILENCE
+    // -120 dB, the same depth the tail length is measured to
+    static constexpr float silenceThreshold = 1.0e-6f;
+    std::atomic<int> tailSamples {0};
+    int silentSamples = 0;
+    bool filtersAsleep = false;
+    // Outputs silence and returns true once quiet input has let the filters ring out
+    bool skipSilence(juce::AudioBuffer<float>& mainBuffer);
+    
+    //PATH CHANGES
+    // Slope, response, bypass, mid/side and multiband changes swap which sections run where.
+    // The old path keeps running next to the new one and is faded out over fadeSeconds.
+    enum class PathKind { Channel, Pipeline, Multiband };
+    struct PathLayout
+    {
+        PathKind kind = PathKind::Channel;
+        bool midSide = false;
+        std::array<int, 4> counts {};   // low, high, side low, side high sections; bands for multiband
+        // Butterworth 12 to 48 dB/oct is one section either way, so the counts alone miss it
+        ResponseType type = ResponseType::Butterworth;
+        Slope lowCutSlope = Slope::Slope_12, highCutSlope = Slope::Slope_12;
+        
+        bool operator== (const PathLayout& other) const
+        {
+            return kind == other.kind && midSide == other.midSide && counts == other.counts
+                && type == other.type && lowCutSlope == other.lowCutSlope && highCutSlope == other.highCutSlope;
+        }
+    };
+    static constexpr double fadeSeconds = 0.01;
+    PathLayout pathLayout;
+    bool hasPathLayout = false;
+    PathKind fadingKind = PathKind::Channel;
+    bool fadingFromCopy = false;
+    // Preallocated snapshots for a path that changes layout but stays in use
+    ChannelCascade<maxChannels, 2 * maxCutSections> fadingCascade;
+    std::array<PipelinedCascade<2 * maxCutSections>, 2> fadingPipelines;
+    MultibandSqueeze fadingMultiband;
+    juce::AudioBuffer<float> fadeBuffer;
+    int fadeLength = 0, fadeRemaining = 0;
+    // The last fadeLength samples of input. A new path runs over them before it fades in,
+    // so it joins with the state it would have had instead of starting from silence.
+    juce::AudioBuffer<float> inputHistory;
+    int historyPosition = 0;
+    bool prewarmPending = false;
+    bool bypassActive = false, hostBypassing = false;
+    
+    bool isBypassed() const;
+    void setPathLayout(const PathLayout& layout, bool forceFade = false);
+    void processFadingPath(juce::dsp::AudioBlock<float>& block);
+    void pushInputHistory(const juce::AudioBuffer<float>& mainBuffer, int startSample, int numSamples);
+    void prewarmPath();
+    
+    //MID/SIDE
+    // Mid uses the main squeeze window, side its own; both share the cutoffs and slopes
+    double lastSideLowCutParam = 20.0, lastSideHighCutParam = 20000.0;
+    bool midSideActive = false;
+    bool isMidSide() const;
+    void setCascadeSections(int channel, const CutSections& lowCut, int numLowCut,
+                            const CutSections& highCut, int numHighCut, size_t numSections);
+    
+    //PRESET RECALL
+    juce::File presetBankFile { PresetBank::getDefaultFile() };
+    static constexpr int recallFifoSize = 4;
+    juce::AbstractFifo recallFifo {recallFifoSize};
+    std::array<PresetRecall, recallFifoSize> recalls;
+    int recallGeneration = 0;
+    // The newest recall whose parameters have all been set
+    std::atomic<int> recallsApplied {0};
+    // Audio thread: stands in for the parameters until they have caught up with it
+    PresetRecall recall;
+    bool recallPending = false, recallArrived = false;
+    void pickUpRecall();
+    bool usePrecomputedRecall(const ChainModulation& modulation, const ChainModulation& ramp) const;
+    
+    //MORPH
+    // Snapshots can be set from whichever thread restores the state, hence the lock. The audio
+    // thread only sees the grid built from them, which the message thread alone writes.
+    juce::CriticalSection morphLock;
+    std::vector<ChainSettings> morphSnapshots;
+    TripleBuffer<MorphGrid> morphGrids;
+    std::atomic<bool> morphGridStale {false};
+    void rebuildMorphGrid();
+    // Rebuilds now on the message thread, anywhere else marks the grid stale for handleAsyncUpdate
+    void requestMorphGridRebuild();
+    // Audio thread: the grid to morph with, or nullptr when morphing is off or the grid is stale
+    const MorphGrid* getMorphGrid();
+    juce::MemoryBlock getMorphState() const;
+    void setMorphState(const juce::MemoryBlock& data);
   
     
     //==============================================================================